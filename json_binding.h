@@ -0,0 +1,645 @@
+#ifndef _C_JSON_BINDING_H_
+#define _C_JSON_BINDING_H_
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <json_headers.h>
+
+/** Binds member to key of same name, in json_bind() of a struct. */
+#define JSON_MNG_FIELD(binder, member)      (binder).field(#member, member)
+
+namespace json_mng
+{
+#ifdef JSON_LIB_RAPIDJSON
+    /** Value that may be absent. Absent members are not written, and null is decoded as absent.
+     *  Absent items of arrays (and root) are written as null.
+     */
+    template <typename T>
+    class COptional {
+    public:
+        COptional(void) : has(false), data() {}
+
+        COptional(const T& value) : has(true), data(value) {}
+
+        COptional& operator=(const T& value) { data = value; has = true; return *this; }
+
+        bool has_value(void) const { return has; }
+
+        explicit operator bool(void) const { return has; }
+
+        T& value(void) { return data; }
+
+        const T& value(void) const { return data; }
+
+        T& operator*(void) { return data; }
+
+        const T& operator*(void) const { return data; }
+
+        T* operator->(void) { return &data; }
+
+        const T* operator->(void) const { return &data; }
+
+        /** Sets default value, and returns it. */
+        T& emplace(void) { data = T(); has = true; return data; }
+
+        void reset(void) { data = T(); has = false; }
+
+    private:
+        bool has;
+
+        T data;
+
+    };
+
+    class CFieldTable;
+
+    /** Decode operations of a type, for SAX events. (one table per type) */
+    typedef struct CBindingOps {
+        bool (*set_null)(void* target);
+        bool (*set_bool)(void* target, bool b);
+        bool (*set_int64)(void* target, int64_t i);
+        bool (*set_uint64)(void* target, uint64_t u);
+        bool (*set_double)(void* target, double d);
+        bool (*set_string)(void* target, const char* str, rapidjson::SizeType length);
+        /** Starts object/array in target. Returns value of new frame and it's ops. (NULL : type mismatch) */
+        void* (*open)(void* target, bool object, const CBindingOps*& frame);
+        /** Members of object frame. (NULL for others) */
+        const CFieldTable* (*fields)(void);
+        /** Appends item to array frame, and returns it. (NULL for others) */
+        void* (*append)(void* target);
+        const CBindingOps* (*element)(void);
+    } CBindingOps;
+
+    typedef struct CField {
+        const char* name;
+        rapidjson::SizeType length;
+        size_t offset;              // of member in struct.
+        const CBindingOps* ops;
+    } CField;
+
+    /** Members of a struct, with perfect hash of names : a key is found by one hash and one compare.
+     *  Built once per struct type at first use.
+     */
+    class CFieldTable {
+    public:
+        CFieldTable(const std::vector<CField>& members) : seed(0), mask(0) {
+            // first one of same name is kept.
+            for(size_t i = 0; i < members.size(); i++) {
+                if ( find(members[i].name, members[i].length, fields) == NULL ) {
+                    fields.push_back(members[i]);
+                }
+            }
+            build();
+        }
+
+        const CField* find(const char* key, rapidjson::SizeType length) const {
+            if ( slots.empty() == true ) {
+                return NULL;
+            }
+            const uint32_t slot = slots[hash(key, length, seed) & mask];
+            if ( slot == 0 ) {
+                return NULL;
+            }
+            const CField& field = fields[slot - 1];
+            if ( field.length != length || memcmp(field.name, key, length) != 0 ) {
+                return NULL;
+            }
+            return &field;
+        }
+
+        size_t size(void) const { return fields.size(); }
+
+    private:
+        static uint32_t hash(const char* key, size_t length, uint32_t seed) {
+            uint32_t h = 2166136261u ^ seed;
+            for(size_t i = 0; i < length; i++) {
+                h = (h ^ static_cast<unsigned char>(key[i])) * 16777619u;
+            }
+            return h ^ (h >> 15);
+        }
+
+        static const CField* find(const char* key, rapidjson::SizeType length, const std::vector<CField>& fields) {
+            for(size_t i = 0; i < fields.size(); i++) {
+                if ( fields[i].length == length && memcmp(fields[i].name, key, length) == 0 ) {
+                    return &fields[i];
+                }
+            }
+            return NULL;
+        }
+
+        /** Finds a seed without collision, growing table after every 256 seeds. (names are distinct) */
+        void build(void) {
+            if ( fields.empty() == true ) {
+                return;
+            }
+            size_t size = 1;
+            while( size < fields.size() * 2 ) {
+                size <<= 1;
+            }
+
+            for(;; size <<= 1) {
+                mask = static_cast<uint32_t>(size - 1);
+                for(seed = 0; seed < 256; seed++) {
+                    slots.assign(size, 0);
+                    size_t i = 0;
+                    for(; i < fields.size(); i++) {
+                        uint32_t& slot = slots[hash(fields[i].name, fields[i].length, seed) & mask];
+                        if ( slot != 0 ) {
+                            break;
+                        }
+                        slot = static_cast<uint32_t>(i + 1);
+                    }
+                    if ( i == fields.size() ) {
+                        return;
+                    }
+                }
+            }
+        }
+
+    private:
+        std::vector<CField> fields;
+
+        std::vector<uint32_t> slots;        // field + 1. (0 : empty)
+
+        uint32_t seed;
+
+        uint32_t mask;
+
+    };
+
+    /** Operations for types without a value of the event. */
+    struct CBindingBase {
+        static bool no_null(void*) { return false; }
+        static bool no_bool(void*, bool) { return false; }
+        static bool no_int64(void*, int64_t) { return false; }
+        static bool no_uint64(void*, uint64_t) { return false; }
+        static bool no_double(void*, double) { return false; }
+        static bool no_string(void*, const char*, rapidjson::SizeType) { return false; }
+        static void* no_open(void*, bool, const CBindingOps*&) { return NULL; }
+
+        /** Value is kept unchanged, if it is not an integer in range of T. */
+        template <typename T>
+        static bool to_integer(double d, T& value) {
+            // upper bound is exclusive : max of T is not exact in double.
+            const double upper = static_cast<double>(std::numeric_limits<T>::max() / 2 + 1) * 2.0;
+            if ( d >= static_cast<double>(std::numeric_limits<T>::min()) && d < upper && std::trunc(d) == d ) {
+                value = static_cast<T>(d);
+                return true;
+            }
+            return false;
+        }
+    };
+
+    /** Binding of a struct with member function template json_bind(Binder&). (primary)
+     *  json_bind() calls binder.field("key", member) for each member. (see JSON_MNG_FIELD)
+     */
+    template <typename T, typename Enable = void>
+    struct CBinding : CBindingBase {
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { no_null, no_bool, no_int64, no_uint64, no_double, no_string,
+                                               open, fields, NULL, NULL };
+            return &table;
+        }
+
+        static void* open(void* target, bool object, const CBindingOps*& frame) {
+            if ( object == false ) {
+                return NULL;
+            }
+            *static_cast<T*>(target) = T();
+            frame = ops();
+            return target;
+        }
+
+        static const CFieldTable* fields(void);
+
+        template <typename Writer>
+        static bool write(Writer& writer, const T& value);
+
+        static bool present(const T&) { return true; }
+    };
+
+    template <>
+    struct CBinding<bool> : CBindingBase {
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { no_null, set_bool, no_int64, no_uint64, no_double, no_string,
+                                               no_open, NULL, NULL, NULL };
+            return &table;
+        }
+
+        static bool set_bool(void* target, bool b) { *static_cast<bool*>(target) = b; return true; }
+
+        template <typename Writer>
+        static bool write(Writer& writer, bool value) { return writer.Bool(value); }
+
+        static bool present(bool) { return true; }
+    };
+
+    /** Integers : values out of range of T are rejected. */
+    template <typename T>
+    struct CBinding<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> : CBindingBase {
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { no_null, no_bool, set_int64, set_uint64, set_double, no_string,
+                                               no_open, NULL, NULL, NULL };
+            return &table;
+        }
+
+        static bool set_int64(void* target, int64_t i) {
+            const bool fit = std::is_signed<T>::value
+                ? (i >= static_cast<int64_t>(std::numeric_limits<T>::min()) && i <= static_cast<int64_t>(std::numeric_limits<T>::max()))
+                : (i >= 0 && static_cast<uint64_t>(i) <= static_cast<uint64_t>(std::numeric_limits<T>::max()));
+            if ( fit == true ) {
+                *static_cast<T*>(target) = static_cast<T>(i);
+            }
+            return fit;
+        }
+
+        static bool set_uint64(void* target, uint64_t u) {
+            if ( u > static_cast<uint64_t>(std::numeric_limits<T>::max()) ) {
+                return false;
+            }
+            *static_cast<T*>(target) = static_cast<T>(u);
+            return true;
+        }
+
+        static bool set_double(void* target, double d) {
+            return to_integer(d, *static_cast<T*>(target));
+        }
+
+        template <typename Writer>
+        static bool write(Writer& writer, T value) {
+            return std::is_signed<T>::value ? writer.Int64(static_cast<int64_t>(value)) : writer.Uint64(static_cast<uint64_t>(value));
+        }
+
+        static bool present(T) { return true; }
+    };
+
+    template <typename T>
+    struct CBinding<T, typename std::enable_if<std::is_floating_point<T>::value>::type> : CBindingBase {
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { no_null, no_bool, set_int64, set_uint64, set_double, no_string,
+                                               no_open, NULL, NULL, NULL };
+            return &table;
+        }
+
+        static bool set_int64(void* target, int64_t i) { *static_cast<T*>(target) = static_cast<T>(i); return true; }
+        static bool set_uint64(void* target, uint64_t u) { *static_cast<T*>(target) = static_cast<T>(u); return true; }
+        static bool set_double(void* target, double d) { *static_cast<T*>(target) = static_cast<T>(d); return true; }
+
+        template <typename Writer>
+        static bool write(Writer& writer, T value) { return writer.Double(static_cast<double>(value)); }
+
+        static bool present(T) { return true; }
+    };
+
+    template <>
+    struct CBinding<std::string> : CBindingBase {
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { no_null, no_bool, no_int64, no_uint64, no_double, set_string,
+                                               no_open, NULL, NULL, NULL };
+            return &table;
+        }
+
+        static bool set_string(void* target, const char* str, rapidjson::SizeType length) {
+            static_cast<std::string*>(target)->assign(str, length);
+            return true;
+        }
+
+        template <typename Writer>
+        static bool write(Writer& writer, const std::string& value) {
+            return writer.String(value.data(), static_cast<rapidjson::SizeType>(value.size()));
+        }
+
+        static bool present(const std::string&) { return true; }
+    };
+
+    template <typename T>
+    struct CBinding<std::vector<T>> : CBindingBase {
+        static_assert(std::is_same<T, bool>::value == false, "std::vector<bool> has no addressable items.");
+
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { no_null, no_bool, no_int64, no_uint64, no_double, no_string,
+                                               open, NULL, append, CBinding<T>::ops };
+            return &table;
+        }
+
+        static void* open(void* target, bool object, const CBindingOps*& frame) {
+            if ( object == true ) {
+                return NULL;
+            }
+            static_cast<std::vector<T>*>(target)->clear();
+            frame = ops();
+            return target;
+        }
+
+        static void* append(void* target) {
+            std::vector<T>* items = static_cast<std::vector<T>*>(target);
+            items->emplace_back();
+            return &items->back();
+        }
+
+        template <typename Writer>
+        static bool write(Writer& writer, const std::vector<T>& value) {
+            if ( writer.StartArray() == false ) {
+                return false;
+            }
+            for(size_t i = 0; i < value.size(); i++) {
+                if ( CBinding<T>::write(writer, value[i]) == false ) {
+                    return false;
+                }
+            }
+            return writer.EndArray(static_cast<rapidjson::SizeType>(value.size()));
+        }
+
+        static bool present(const std::vector<T>&) { return true; }
+    };
+
+    template <typename T>
+    struct CBinding<COptional<T>> : CBindingBase {
+        static const CBindingOps* ops(void) {
+            static const CBindingOps table = { set_null, set_bool, set_int64, set_uint64, set_double, set_string,
+                                               open, NULL, NULL, NULL };
+            return &table;
+        }
+
+        static bool set_null(void* target) { static_cast<COptional<T>*>(target)->reset(); return true; }
+
+        static bool set_bool(void* target, bool b) {
+            return CBinding<T>::ops()->set_bool(&static_cast<COptional<T>*>(target)->emplace(), b);
+        }
+
+        static bool set_int64(void* target, int64_t i) {
+            return CBinding<T>::ops()->set_int64(&static_cast<COptional<T>*>(target)->emplace(), i);
+        }
+
+        static bool set_uint64(void* target, uint64_t u) {
+            return CBinding<T>::ops()->set_uint64(&static_cast<COptional<T>*>(target)->emplace(), u);
+        }
+
+        static bool set_double(void* target, double d) {
+            return CBinding<T>::ops()->set_double(&static_cast<COptional<T>*>(target)->emplace(), d);
+        }
+
+        static bool set_string(void* target, const char* str, rapidjson::SizeType length) {
+            return CBinding<T>::ops()->set_string(&static_cast<COptional<T>*>(target)->emplace(), str, length);
+        }
+
+        static void* open(void* target, bool object, const CBindingOps*& frame) {
+            return CBinding<T>::ops()->open(&static_cast<COptional<T>*>(target)->emplace(), object, frame);
+        }
+
+        template <typename Writer>
+        static bool write(Writer& writer, const COptional<T>& value) {
+            if ( value.has_value() == false ) {
+                return writer.Null();
+            }
+            return CBinding<T>::write(writer, value.value());
+        }
+
+        static bool present(const COptional<T>& value) { return value.has_value(); }
+    };
+
+    /** Binder of json_bind() : collects members of a default object. */
+    class CFieldCollector {
+    public:
+        CFieldCollector(const void* object) : base(static_cast<const char*>(object)) {}
+
+        template <size_t N, typename M>
+        void field(const char (&name)[N], M& member) {
+            CField field;
+            field.name = name;
+            field.length = static_cast<rapidjson::SizeType>(N - 1);
+            field.offset = static_cast<size_t>(reinterpret_cast<const char*>(&member) - base);
+            field.ops = CBinding<M>::ops();
+            fields.push_back(field);
+        }
+
+        std::vector<CField> fields;
+
+    private:
+        const char* base;
+
+    };
+
+    /** Binder of json_bind() : writes present members. */
+    template <typename Writer>
+    class CFieldEncoder {
+    public:
+        CFieldEncoder(Writer& writer) : writer(writer), ok(true) {}
+
+        template <size_t N, typename M>
+        void field(const char (&name)[N], M& member) {
+            if ( ok == true && CBinding<M>::present(member) == true ) {
+                ok = writer.Key(name, static_cast<rapidjson::SizeType>(N - 1)) && CBinding<M>::write(writer, member);
+            }
+        }
+
+        Writer& writer;
+
+        bool ok;
+
+    };
+
+    template <typename T, typename Enable>
+    const CFieldTable* CBinding<T, Enable>::fields(void) {
+        struct Builder {
+            static std::vector<CField> collect(void) {
+                T object;
+                CFieldCollector collector(&object);
+                object.json_bind(collector);
+                return collector.fields;
+            }
+        };
+        static const CFieldTable table(Builder::collect());
+        return &table;
+    }
+
+    template <typename T, typename Enable>
+    template <typename Writer>
+    bool CBinding<T, Enable>::write(Writer& writer, const T& value) {
+        CFieldEncoder<Writer> encoder(writer);
+
+        if ( writer.StartObject() == false ) {
+            return false;
+        }
+        // json_bind() only reads members with encoder.
+        const_cast<T&>(value).json_bind(encoder);
+        return encoder.ok == true && writer.EndObject();
+    }
+
+    /** SAX handler for Reader, decoding into a bound value by ops of types. (no DOM)
+     *  Fails on type mismatch, or value out of range. Unknown members are skipped.
+     */
+    class CBindingHandler {
+    public:
+        CBindingHandler(void* root, const CBindingOps* ops) : root(root), root_ops(ops), skip(0) {}
+
+        bool Null(void) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            return target == NULL || ops->set_null(target);
+        }
+
+        bool Bool(bool b) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            return target == NULL || ops->set_bool(target, b);
+        }
+
+        bool Int(int i) { return Int64(i); }
+
+        bool Uint(unsigned u) { return Int64(u); }
+
+        bool Int64(int64_t i) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            return target == NULL || ops->set_int64(target, i);
+        }
+
+        bool Uint64(uint64_t u) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            return target == NULL || ops->set_uint64(target, u);
+        }
+
+        bool Double(double d) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            return target == NULL || ops->set_double(target, d);
+        }
+
+        bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; }
+
+        bool String(const char* str, rapidjson::SizeType length, bool) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            return target == NULL || ops->set_string(target, str, length);
+        }
+
+        bool Key(const char* str, rapidjson::SizeType length, bool) {
+            if ( skip == 0 ) {
+                Frame& frame = stack.back();
+                frame.field = frame.table->find(str, length);
+            }
+            return true;
+        }
+
+        bool StartObject(void) { return open(true); }
+
+        bool EndObject(rapidjson::SizeType) { return close(); }
+
+        bool StartArray(void) { return open(false); }
+
+        bool EndArray(rapidjson::SizeType) { return close(); }
+
+    private:
+        typedef struct Frame {
+            const CBindingOps* ops;
+            void* target;
+            const CFieldTable* table;    // object frame.
+            const CField* field;        // member of current key. (NULL : skipped)
+        } Frame;
+
+        /** Value of next event, and it's ops. NULL if it is skipped. */
+        void* value_target(const CBindingOps*& ops) {
+            if ( skip != 0 ) {
+                return NULL;
+            }
+            if ( stack.empty() == true ) {
+                ops = root_ops;
+                return root;
+            }
+            Frame& frame = stack.back();
+            if ( frame.table != NULL ) {
+                if ( frame.field == NULL ) {
+                    return NULL;
+                }
+                ops = frame.field->ops;
+                return static_cast<char*>(frame.target) + frame.field->offset;
+            }
+            ops = frame.ops->element();
+            return frame.ops->append(frame.target);
+        }
+
+        bool open(bool object) {
+            const CBindingOps* ops = NULL;
+            void* target = value_target(ops);
+            Frame frame;
+
+            if ( target == NULL ) {
+                skip++;
+                return true;
+            }
+            frame.target = ops->open(target, object, frame.ops);
+            if ( frame.target == NULL ) {
+                return false;
+            }
+            frame.table = (frame.ops->fields != NULL) ? frame.ops->fields() : NULL;
+            frame.field = NULL;
+            stack.push_back(frame);
+            return true;
+        }
+
+        bool close(void) {
+            if ( skip != 0 ) {
+                skip--;
+            }
+            else {
+                stack.pop_back();
+            }
+            return true;
+        }
+
+    private:
+        void* root;
+
+        const CBindingOps* root_ops;
+
+        std::vector<Frame> stack;
+
+        size_t skip;                    // depth in skipped value.
+
+    };
+
+    /** Decodes buffer into value. Returns false if buffer is not valid JSON, or does not fit type of value. */
+    template <typename T>
+    bool decode(const char* buffer, T& value, size_t* error_offset=NULL) {
+        Reader_Type reader;
+        rapidjson::StringStream stream(buffer);
+        CBindingHandler handler(&value, CBinding<T>::ops());
+        rapidjson::ParseResult result = reader.Parse<rapidjson::kParseDefaultFlags | rapidjson::kParseIterativeFlag>(stream, handler);
+
+        if ( error_offset != NULL ) {
+            *error_offset = result.Offset();
+        }
+        return result.IsError() == false;
+    }
+
+    /** Decoded value of buffer. Empty on failure. */
+    template <typename T>
+    COptional<T> decode(const std::string& buffer) {
+        COptional<T> ret;
+
+        if ( decode(buffer.c_str(), ret.emplace()) == false ) {
+            ret.reset();
+        }
+        return ret;
+    }
+
+    /** Writes value to writer. (rapidjson Writer, or PrettyWriter) */
+    template <typename T, typename Writer>
+    bool encode(const T& value, Writer& writer) {
+        return CBinding<T>::write(writer, value);
+    }
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+}
+
+#endif // _C_JSON_BINDING_H_
@@ -0,0 +1,346 @@
+#include <cassert>
+#include <string.h>
+#include <algorithm>
+
+#include <logger.h>
+#include <json_canonical.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+namespace {
+
+/** Integral doubles within +-2^53 are exact, and are normalized to integer. */
+const double max_exact_double = 9007199254740992.0;
+
+/** Seeds of hash by type. */
+const uint64_t seed_null = 0x6e756c6cULL;
+const uint64_t seed_false = 0x66616c73ULL;
+const uint64_t seed_true = 0x74727565ULL;
+const uint64_t seed_integer = 0x696e7465ULL;
+const uint64_t seed_unsigned = 0x75696e74ULL;
+const uint64_t seed_double = 0x646f7562ULL;
+const uint64_t seed_string = 0x73747269ULL;
+const uint64_t seed_key = 0x6b657973ULL;
+const uint64_t seed_array = 0x61727261ULL;
+const uint64_t seed_object = 0x6f626a65ULL;
+
+const uint64_t c1 = 0x87c37b91114253d5ULL;
+const uint64_t c2 = 0x4cf5ad432745937fULL;
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/** Finalizer of MurmurHash3. */
+inline uint64_t fmix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline bool exact_integer(double d, int64_t& i) {
+    if ( d >= -max_exact_double && d <= max_exact_double && d == static_cast<double>(static_cast<int64_t>(d)) ) {
+        i = static_cast<int64_t>(d);
+        return true;
+    }
+    return false;
+}
+
+}
+
+/*******************************
+ * Public Function Definiction.
+ */
+bool CJsonCanonical::write(const Value_Type& value, Buffer_Type& buffer) {
+    Writer_Type writer(buffer);
+    std::vector<const Value_Type::Member*> members;
+
+    return write_value(value, writer, members);
+}
+
+CContentHash::CContentHash(void) {
+    reset();
+}
+
+CContentHash::~CContentHash(void) {
+    stack.clear();
+}
+
+void CContentHash::reset(void) {
+    stack.clear();
+    root.low = 0;
+    root.high = 0;
+}
+
+Hash128 CContentHash::hash(const Value_Type& value) {
+    CContentHash hasher;
+
+    value.Accept(hasher);
+    return hasher.digest();
+}
+
+bool CContentHash::hash_message(const char* message, Hash128& result) {
+    Reader_Type reader;
+    rapidjson::StringStream stream(message);
+
+    reset();
+    if ( reader.Parse<rapidjson::kParseDefaultFlags>(stream, *this).IsError() == true ) {
+        LOGW("Invalid JSON message.(offset %zu)", reader.GetErrorOffset());
+        return false;
+    }
+    result = root;
+    return true;
+}
+
+bool CContentHash::Null(void) {
+    return value(hash_integer(0, seed_null));
+}
+
+bool CContentHash::Bool(bool b) {
+    return value(hash_integer(0, b ? seed_true : seed_false));
+}
+
+bool CContentHash::Int(int i) {
+    return Int64(i);
+}
+
+bool CContentHash::Uint(unsigned u) {
+    return Int64(u);
+}
+
+bool CContentHash::Int64(int64_t i) {
+    return value(hash_integer(static_cast<uint64_t>(i), seed_integer));
+}
+
+bool CContentHash::Uint64(uint64_t u) {
+    if ( u <= static_cast<uint64_t>(INT64_MAX) ) {
+        return Int64(static_cast<int64_t>(u));
+    }
+    return value(hash_integer(u, seed_unsigned));
+}
+
+bool CContentHash::Double(double d) {
+    int64_t i = 0;
+    uint64_t bits = 0;
+
+    if ( exact_integer(d, i) == true ) {
+        return Int64(i);
+    }
+    memcpy(&bits, &d, sizeof(bits));
+    return value(hash_integer(bits, seed_double));
+}
+
+bool CContentHash::RawNumber(const char* str, rapidjson::SizeType length, bool copy) {
+    // numbers are normalized by value : not used without kParseNumbersAsStringsFlag.
+    (void)str;
+    (void)length;
+    (void)copy;
+    return false;
+}
+
+bool CContentHash::String(const char* str, rapidjson::SizeType length, bool copy) {
+    (void)copy;
+    return value(hash_bytes(str, length, seed_string));
+}
+
+bool CContentHash::StartObject(void) {
+    Frame frame;
+    frame.is_object = true;
+    frame.sum.low = 0;
+    frame.sum.high = 0;
+    frame.key = frame.sum;
+    stack.push_back(frame);
+    return true;
+}
+
+bool CContentHash::Key(const char* str, rapidjson::SizeType length, bool copy) {
+    (void)copy;
+    assert(stack.empty() == false && stack.back().is_object == true);
+    stack.back().key = hash_bytes(str, length, seed_key);
+    return true;
+}
+
+bool CContentHash::EndObject(rapidjson::SizeType count) {
+    Hash128 header;
+    header.low = seed_object;
+    header.high = count;
+
+    const Hash128 hash = combine(header, stack.back().sum);
+    stack.pop_back();
+    return value(hash);
+}
+
+bool CContentHash::StartArray(void) {
+    Frame frame;
+    frame.is_object = false;
+    frame.sum.low = seed_array;
+    frame.sum.high = ~seed_array;
+    frame.key.low = 0;
+    frame.key.high = 0;
+    stack.push_back(frame);
+    return true;
+}
+
+bool CContentHash::EndArray(rapidjson::SizeType count) {
+    Hash128 trailer;
+    trailer.low = count;
+    trailer.high = seed_array;
+
+    const Hash128 hash = combine(stack.back().sum, trailer);
+    stack.pop_back();
+    return value(hash);
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+bool CJsonCanonical::write_value(const Value_Type& value, Writer_Type& writer, std::vector<const Value_Type::Member*>& members) {
+    switch( value.GetType() ) {
+    case rapidjson::kNullType:
+        return writer.Null();
+    case rapidjson::kFalseType:
+        return writer.Bool(false);
+    case rapidjson::kTrueType:
+        return writer.Bool(true);
+    case rapidjson::kNumberType:
+        {
+            int64_t i = 0;
+            if ( value.IsInt64() == true ) {
+                return writer.Int64(value.GetInt64());
+            }
+            if ( value.IsUint64() == true ) {
+                return writer.Uint64(value.GetUint64());
+            }
+            if ( exact_integer(value.GetDouble(), i) == true ) {
+                return writer.Int64(i);
+            }
+            return writer.Double(value.GetDouble());
+        }
+    case rapidjson::kStringType:
+        return writer.String(value.GetString(), value.GetStringLength());
+    case rapidjson::kArrayType:
+        writer.StartArray();
+        for(Value_Type::ConstValueIterator itr = value.Begin(); itr != value.End(); itr++) {
+            if ( write_value(*itr, writer, members) == false ) {
+                return false;
+            }
+        }
+        return writer.EndArray();
+    case rapidjson::kObjectType:
+        {
+            // members of this object are sorted on top of the stack.
+            const size_t base = members.size();
+            for(Value_Type::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); itr++) {
+                members.push_back(&(*itr));
+            }
+            std::stable_sort(members.begin() + base, members.end(), less_name);
+
+            writer.StartObject();
+            for(size_t i = base; i < base + value.MemberCount(); i++) {
+                const Value_Type::Member* member = members[i];
+                writer.Key(member->name.GetString(), member->name.GetStringLength());
+                if ( write_value(member->value, writer, members) == false ) {
+                    return false;
+                }
+            }
+            members.resize(base);
+            return writer.EndObject();
+        }
+    default:
+        return false;
+    }
+}
+
+bool CJsonCanonical::less_name(const Value_Type::Member* a, const Value_Type::Member* b) {
+    const rapidjson::SizeType a_length = a->name.GetStringLength();
+    const rapidjson::SizeType b_length = b->name.GetStringLength();
+    const int ret = memcmp(a->name.GetString(), b->name.GetString(), std::min(a_length, b_length));
+
+    return ret < 0 || (ret == 0 && a_length < b_length);
+}
+
+bool CContentHash::value(const Hash128& hash) {
+    if ( stack.empty() == true ) {
+        root = hash;
+        return true;
+    }
+
+    Frame& parent = stack.back();
+    if ( parent.is_object == true ) {
+        // sum is independent of member order.
+        const Hash128 member = combine(parent.key, hash);
+        parent.sum.low += member.low;
+        parent.sum.high += member.high;
+    }
+    else {
+        parent.sum = combine(parent.sum, hash);
+    }
+    return true;
+}
+
+Hash128 CContentHash::hash_bytes(const char* data, size_t length, uint64_t seed) {
+    // MurmurHash3 x64 128
+    uint64_t h1 = seed;
+    uint64_t h2 = ~seed;
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    size_t i = 0;
+
+    for(; i + 16 <= length; i += 16) {
+        memcpy(&k1, data + i, 8);
+        memcpy(&k2, data + i + 8, 8);
+        h1 ^= rotl64(k1 * c1, 31) * c2;
+        h1 = (rotl64(h1, 27) + h2) * 5 + 0x52dce729;
+        h2 ^= rotl64(k2 * c2, 33) * c1;
+        h2 = (rotl64(h2, 31) + h1) * 5 + 0x38495ab5;
+    }
+
+    const size_t rest = length - i;
+    k1 = 0;
+    k2 = 0;
+    memcpy(&k1, data + i, std::min<size_t>(rest, 8));
+    if ( rest > 8 ) {
+        memcpy(&k2, data + i + 8, rest - 8);
+    }
+    h1 ^= rotl64(k1 * c1, 31) * c2;
+    h2 ^= rotl64(k2 * c2, 33) * c1;
+
+    h1 ^= length;
+    h2 ^= length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    Hash128 hash;
+    hash.low = h1;
+    hash.high = h2;
+    return hash;
+}
+
+Hash128 CContentHash::hash_integer(uint64_t bits, uint64_t seed) {
+    Hash128 hash;
+    hash.low = fmix64(bits ^ seed);
+    hash.high = fmix64(rotl64(bits, 32) * c1 + seed) ^ hash.low;
+    return hash;
+}
+
+Hash128 CContentHash::combine(const Hash128& a, const Hash128& b) {
+    Hash128 hash;
+    hash.low = fmix64(a.low ^ (b.low * c1) ^ rotl64(b.high, 29));
+    hash.high = fmix64(a.high ^ (b.high * c2) ^ rotl64(b.low, 41) ^ hash.low);
+    return hash;
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
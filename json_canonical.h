@@ -0,0 +1,108 @@
+#ifndef _C_JSON_CANONICAL_H_
+#define _C_JSON_CANONICAL_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+
+namespace json_mng
+{
+    /** 128-bit content hash. (low : 64-bit hash) */
+    typedef struct Hash128 {
+        uint64_t low;
+        uint64_t high;
+
+        bool operator==(const Hash128& other) const { return low == other.low && high == other.high; }
+        bool operator!=(const Hash128& other) const { return !(*this == other); }
+    } Hash128;
+
+    /** Canonical serializer.
+     *  - members of object are sorted by name. (byte-order of UTF-8, same as code-point order)
+     *  - integral numbers within +-2^53 are written as integer. (1.0 -> 1, -0.0 -> 0)
+     *    other numbers are written in the shortest form that round-trips.
+     *  - no white-space. only '"', '\\' and control characters are escaped.
+     */
+    class CJsonCanonical {
+    public:
+        /** Appends canonical text of value to buffer. Returns false for NaN or Inf. */
+        static bool write(const Value_Type& value, Buffer_Type& buffer);
+
+    private:
+        /** Doubles are written with the shortest round-trip digits. (not Grisu2) */
+        typedef rapidjson::Writer<Buffer_Type, rapidjson::UTF8<>, rapidjson::UTF8<>, rapidjson::CrtAllocator,
+                                  rapidjson::kWriteDefaultFlags | rapidjson::kWriteShortestDoubleFlag> Writer_Type;
+
+        /** members : stack of sorted members of objects being written. */
+        static bool write_value(const Value_Type& value, Writer_Type& writer, std::vector<const Value_Type::Member*>& members);
+
+        static bool less_name(const Value_Type::Member* a, const Value_Type::Member* b);
+
+    };
+
+    /** Streaming content hash. (SAX handler)
+     *  Values with same canonical text have same hash, without producing the text :
+     *  object-hash is a sum over members, so member order does not matter,
+     *  and numbers are normalized like CJsonCanonical.
+     *  Same handler hashes a DOM (Value::Accept) or a text during SAX parsing. (Reader)
+     */
+    class CContentHash {
+    public:
+        CContentHash(void);
+
+        ~CContentHash(void);
+
+        void reset(void);
+
+        /** Hash of the last complete root value. */
+        Hash128 digest(void) const { return root; }
+
+        /** Hash of value in DOM. */
+        static Hash128 hash(const Value_Type& value);
+
+        /** Hash of JSON text by SAX parsing, without DOM. Returns false if text is not valid. */
+        bool hash_message(const char* message, Hash128& result);
+
+        // SAX handler.
+        bool Null(void);
+        bool Bool(bool b);
+        bool Int(int i);
+        bool Uint(unsigned u);
+        bool Int64(int64_t i);
+        bool Uint64(uint64_t u);
+        bool Double(double d);
+        bool RawNumber(const char* str, rapidjson::SizeType length, bool copy);
+        bool String(const char* str, rapidjson::SizeType length, bool copy);
+        bool StartObject(void);
+        bool Key(const char* str, rapidjson::SizeType length, bool copy);
+        bool EndObject(rapidjson::SizeType count);
+        bool StartArray(void);
+        bool EndArray(rapidjson::SizeType count);
+
+    private:
+        typedef struct Frame {
+            bool is_object;
+            Hash128 sum;        // object : sum of members, array : ordered fold of elements.
+            Hash128 key;        // hash of current member name.
+        } Frame;
+
+        /** Adds hash of a complete value to the parent. */
+        bool value(const Hash128& hash);
+
+        static Hash128 hash_bytes(const char* data, size_t length, uint64_t seed);
+
+        static Hash128 hash_integer(uint64_t bits, uint64_t seed);
+
+        static Hash128 combine(const Hash128& a, const Hash128& b);
+
+    private:
+        std::vector<Frame> stack;
+
+        Hash128 root;
+
+    };
+}
+
+#endif // _C_JSON_CANONICAL_H_
@@ -0,0 +1,699 @@
+#include <cassert>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <logger.h>
+#include <json_codegen.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+namespace {
+
+const char* const keywords[] = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+    "case", "catch", "char", "char16_t", "char32_t", "class", "compl", "const", "constexpr",
+    "const_cast", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+    "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert",
+    "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+    "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+    "volatile", "wchar_t", "while", "xor", "xor_eq",
+};
+
+/** Value events of Reader, with the expression of value for each type. */
+typedef struct Event {
+    const char* signature;
+    const char* integer;        // value for E_FIELD_TYPE_INTEGER. (NULL : mismatch)
+    const char* integer_check;  // statement before store.
+    const char* number;
+    const char* boolean;
+    const char* string;
+} Event;
+
+const Event events[] = {
+    { "bool Bool(bool b)", NULL, NULL, NULL, "b", NULL },
+    { "bool Int64(int64_t i)", "i", NULL, "static_cast<double>(i)", NULL, NULL },
+    { "bool Uint64(uint64_t u)", "static_cast<int64_t>(u)",
+      "if ( u > static_cast<uint64_t>(INT64_MAX) ) return false;", "static_cast<double>(u)", NULL, NULL },
+    { "bool Double(double d)", "static_cast<int64_t>(d)",
+      "if ( is_integer(d) == false ) return false;", "d", NULL, NULL },
+    { "bool String(const char* str, rapidjson::SizeType length, bool copy)", NULL, NULL, NULL, NULL,
+      "std::string(str, length)" },
+};
+
+/** Expression of event value stored into type kind. NULL if event does not match kind. */
+const char* value_of(const Event& event, E_FIELD_TYPE kind, const char*& check) {
+    check = NULL;
+    switch( kind ) {
+    case E_FIELD_TYPE::E_FIELD_TYPE_INTEGER:
+        check = event.integer_check;
+        return event.integer;
+    case E_FIELD_TYPE::E_FIELD_TYPE_NUMBER:
+        return event.number;
+    case E_FIELD_TYPE::E_FIELD_TYPE_BOOL:
+        return event.boolean;
+    case E_FIELD_TYPE::E_FIELD_TYPE_STRING:
+        return event.string;
+    default:
+        return NULL;
+    }
+}
+
+std::string to_string(size_t value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%zu", value);
+    return buf;
+}
+
+}
+
+/*******************************
+ * Public Function Definiction.
+ */
+CSchemaCodegen::CSchemaCodegen(std::shared_ptr<CJsonSchema> schema) : schema(schema) {
+    assert(schema.get() != NULL);
+}
+
+CSchemaCodegen::~CSchemaCodegen(void) {
+    structs.clear();
+    arrays.clear();
+    names.clear();
+    objects.clear();
+    schema.reset();
+}
+
+bool CSchemaCodegen::generate(const std::string& root_name, const std::string& name_space, std::string& code) {
+    const Value_Type* root = resolve(schema->get_source(), 0);
+    size_t index = 0;
+
+    structs.clear();
+    arrays.clear();
+    names.clear();
+    objects.clear();
+    code.clear();
+
+    if ( root == NULL || root->IsObject() == false ||
+         (CSchemaPlan::parse_type(*root) != E_FIELD_TYPE::E_FIELD_TYPE_OBJECT &&
+          CSchemaPlan::parse_type(*root) != E_FIELD_TYPE::E_FIELD_TYPE_ANY) ) {
+        LOGW("Root of schema is not an object.(%s)", schema->get_key().c_str());
+        return false;
+    }
+    if ( add_struct(*root, camel(root_name), 0, index) == false ) {
+        return false;
+    }
+    assert(index == structs.size() - 1);
+
+    const std::string root_struct = structs[index].name;
+    std::string guard = "_" + identifier(root_struct) + "_CODEGEN_H_";
+    for(size_t i = 0; i < guard.length(); i++) {
+        guard[i] = static_cast<char>(toupper(static_cast<unsigned char>(guard[i])));
+    }
+
+    code += "// Generated by json_codegen from schema " + schema->get_key() + ". Do not edit.\n";
+    code += "#ifndef " + guard + "\n#define " + guard + "\n\n";
+    code += "#include <cstddef>\n#include <cstdint>\n#include <cstring>\n#include <string>\n#include <vector>\n\n";
+    code += "#include <rapidjson/reader.h>\n\n";
+    if ( name_space.empty() == false ) {
+        code += "namespace " + name_space + "\n{\n";
+    }
+    write_structs(code);
+    write_decoder(root_struct, code);
+    write_encoders(root_struct, code);
+
+    code += "    /** Decodes json into value. Returns false if json is not valid for schema. */\n";
+    code += "    inline bool decode(const char* json, " + root_struct + "& value, size_t* error_offset = NULL) {\n";
+    code += "        rapidjson::Reader reader;\n";
+    code += "        rapidjson::StringStream stream(json);\n";
+    code += "        " + root_struct + "Decoder decoder(value);\n";
+    code += "        rapidjson::ParseResult result = reader.Parse<rapidjson::kParseDefaultFlags | rapidjson::kParseIterativeFlag>(stream, decoder);\n";
+    code += "        if ( error_offset != NULL ) *error_offset = result.Offset();\n";
+    code += "        return !result.IsError();\n";
+    code += "    }\n\n";
+    code += "    /** Writes value to writer. (rapidjson Writer or PrettyWriter) */\n";
+    code += "    template <typename Writer>\n";
+    code += "    bool encode(Writer& writer, const " + root_struct + "& value) {\n";
+    code += "        return codegen_" + root_struct + "::write_value(writer, value);\n";
+    code += "    }\n";
+
+    if ( name_space.empty() == false ) {
+        code += "}\n";
+    }
+    code += "\n#endif // " + guard + "\n";
+    return true;
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+bool CSchemaCodegen::add_struct(const Value_Type& schema, const std::string& name, size_t depth, size_t& index) {
+    Struct object;
+    std::set<std::string> idents;
+
+    object.name = unique_name(name);
+
+    Value_Type::ConstMemberIterator properties = schema.FindMember("properties");
+    if ( properties != schema.MemberEnd() && properties->value.IsObject() == true ) {
+        if ( properties->value.MemberCount() > max_members ) {
+            LOGW("Too many properties of object.(%s : %u)", object.name.c_str(), properties->value.MemberCount());
+            return false;
+        }
+        Value_Type::ConstMemberIterator required = schema.FindMember("required");
+
+        for(Value_Type::ConstMemberIterator itr = properties->value.MemberBegin(); itr != properties->value.MemberEnd(); itr++) {
+            Member member;
+
+            member.name.assign(itr->name.GetString(), itr->name.GetStringLength());
+            if ( add_type(itr->value, object.name + camel(member.name), depth + 1, member.type) == false ) {
+                return false;
+            }
+            if ( member.type.kind == E_FIELD_TYPE::E_FIELD_TYPE_ANY ) {
+                continue;   // skipped by decoder.
+            }
+
+            member.required = false;
+            if ( required != schema.MemberEnd() && required->value.IsArray() == true ) {
+                for(Value_Type::ConstValueIterator name = required->value.Begin(); name != required->value.End(); name++) {
+                    if ( name->IsString() == true && *name == itr->name ) {
+                        member.required = true;
+                        break;
+                    }
+                }
+            }
+
+            // optional member also takes "has_<ident>" flag : both names must be free.
+            member.ident = identifier(member.name);
+            while( idents.count(member.ident) != 0 ||
+                   (member.required == false && idents.count("has_" + member.ident) != 0) ) {
+                member.ident += "_";
+            }
+            idents.insert(member.ident);
+            if ( member.required == false ) {
+                idents.insert("has_" + member.ident);
+            }
+            object.members.push_back(member);
+        }
+    }
+
+    structs.push_back(object);
+    index = structs.size() - 1;
+    return true;
+}
+
+bool CSchemaCodegen::add_type(const Value_Type& schema, const std::string& name, size_t depth, Type& type) {
+    const Value_Type* object = resolve(schema, 0);
+
+    type.kind = E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+    type.index = 0;
+    if ( depth >= max_depth ) {
+        LOGW("Nesting-depth of schema exceeds limit.(%s)", name.c_str());
+        return false;
+    }
+    if ( object == NULL ) {
+        return true;
+    }
+
+    type.kind = CSchemaPlan::parse_type(*object);
+    switch( type.kind ) {
+    case E_FIELD_TYPE::E_FIELD_TYPE_OBJECT:
+        {
+            // schemas of same "$ref" share a struct.
+            std::map<const Value_Type*, size_t>::const_iterator itr = objects.find(object);
+            if ( itr != objects.end() ) {
+                type.index = itr->second;
+                return true;
+            }
+            if ( add_struct(*object, name, depth, type.index) == false ) {
+                return false;
+            }
+            objects[object] = type.index;
+            return true;
+        }
+    case E_FIELD_TYPE::E_FIELD_TYPE_ARRAY:
+        {
+            Value_Type::ConstMemberIterator items = object->FindMember("items");
+            Type item;
+
+            type.kind = E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+            if ( items == object->MemberEnd() || items->value.IsObject() == false ) {
+                return true;    // tuple or any items.
+            }
+            if ( add_type(items->value, name + "Item", depth + 1, item) == false ) {
+                return false;
+            }
+            if ( item.kind == E_FIELD_TYPE::E_FIELD_TYPE_ANY ) {
+                return true;
+            }
+
+            type.kind = E_FIELD_TYPE::E_FIELD_TYPE_ARRAY;
+            for(type.index = 0; type.index < arrays.size(); type.index++) {
+                if ( arrays[type.index].kind == item.kind && arrays[type.index].index == item.index ) {
+                    return true;
+                }
+            }
+            arrays.push_back(item);
+            return true;
+        }
+    case E_FIELD_TYPE::E_FIELD_TYPE_NULL:
+        type.kind = E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+        return true;
+    default:
+        return true;
+    }
+}
+
+const Value_Type* CSchemaCodegen::resolve(const Value_Type& schema, size_t depth) const {
+    if ( schema.IsObject() == false ) {
+        return &schema;
+    }
+    Value_Type::ConstMemberIterator ref = schema.FindMember("$ref");
+    if ( ref == schema.MemberEnd() || ref->value.IsString() == false ) {
+        return &schema;
+    }
+    // only reference in this document. (ex: "#/definitions/item")
+    if ( ref->value.GetStringLength() == 0 || ref->value.GetString()[0] != '#' || depth >= max_depth ) {
+        return NULL;
+    }
+
+    Pointer_Type pointer(ref->value.GetString(), ref->value.GetStringLength());
+    const Value_Type* target = pointer.IsValid() ? pointer.Get(this->schema->get_source()) : NULL;
+    if ( target == NULL ) {
+        LOGW("Can not resolve reference.(%s)", ref->value.GetString());
+        return NULL;
+    }
+    return resolve(*target, depth + 1);
+}
+
+std::string CSchemaCodegen::type_name(E_FIELD_TYPE kind, size_t index) const {
+    Type type;
+    type.kind = kind;
+    type.index = index;
+    return type_name(type);
+}
+
+std::string CSchemaCodegen::type_name(const Type& type) const {
+    switch( type.kind ) {
+    case E_FIELD_TYPE::E_FIELD_TYPE_BOOL:
+        return "bool";
+    case E_FIELD_TYPE::E_FIELD_TYPE_INTEGER:
+        return "int64_t";
+    case E_FIELD_TYPE::E_FIELD_TYPE_NUMBER:
+        return "double";
+    case E_FIELD_TYPE::E_FIELD_TYPE_STRING:
+        return "std::string";
+    case E_FIELD_TYPE::E_FIELD_TYPE_OBJECT:
+        return structs[type.index].name;
+    case E_FIELD_TYPE::E_FIELD_TYPE_ARRAY:
+        return "std::vector<" + type_name(arrays[type.index]) + ">";
+    default:
+        assert(false);
+        return "";
+    }
+}
+
+size_t CSchemaCodegen::frame_type(const Type& type) const {
+    return (type.kind == E_FIELD_TYPE::E_FIELD_TYPE_ARRAY) ? structs.size() + type.index : type.index;
+}
+
+void CSchemaCodegen::write_structs(std::string& code) const {
+    for(size_t i = 0; i < structs.size(); i++) {
+        const Struct& object = structs[i];
+
+        code += "    struct " + object.name + " {\n";
+        for(size_t j = 0; j < object.members.size(); j++) {
+            const Member& member = object.members[j];
+            std::string init;
+
+            switch( member.type.kind ) {
+            case E_FIELD_TYPE::E_FIELD_TYPE_BOOL:
+                init = " = false";
+                break;
+            case E_FIELD_TYPE::E_FIELD_TYPE_INTEGER:
+            case E_FIELD_TYPE::E_FIELD_TYPE_NUMBER:
+                init = " = 0";
+                break;
+            default:
+                break;
+            }
+            code += "        " + type_name(member.type) + " " + member.ident + init + ";\n";
+            if ( member.required == false ) {
+                code += "        bool has_" + member.ident + " = false;\n";
+            }
+        }
+        code += "    };\n\n";
+    }
+}
+
+void CSchemaCodegen::write_decoder(const std::string& root_name, std::string& code) const {
+    const std::string detail = "codegen_" + root_name;
+    const std::string decoder = root_name + "Decoder";
+
+    code += "    namespace " + detail + "\n    {\n";
+    // member of key : switch on length, then compare.
+    for(size_t i = 0; i < structs.size(); i++) {
+        const Struct& object = structs[i];
+        std::map<size_t, std::vector<size_t>> lengths;
+
+        for(size_t j = 0; j < object.members.size(); j++) {
+            lengths[object.members[j].name.length()].push_back(j);
+        }
+        code += "        inline int find_" + object.name + "(const char* key, rapidjson::SizeType length) {\n";
+        if ( lengths.empty() == true ) {
+            code += "            (void)key;\n            (void)length;\n";
+        }
+        else {
+            code += "            switch( length ) {\n";
+            for(std::map<size_t, std::vector<size_t>>::const_iterator itr = lengths.begin(); itr != lengths.end(); itr++) {
+                code += "            case " + to_string(itr->first) + ":\n";
+                for(size_t j = 0; j < itr->second.size(); j++) {
+                    code += "                if ( std::memcmp(key, " + literal(object.members[itr->second[j]].name) + ", " +
+                            to_string(itr->first) + ") == 0 ) return " + to_string(itr->second[j]) + ";\n";
+                }
+                code += "                break;\n";
+            }
+            code += "            }\n";
+        }
+        code += "            return -1;\n        }\n\n";
+    }
+
+    code += "        inline uint64_t required_of(int type) {\n";
+    code += "            static const uint64_t masks[] = {";
+    for(size_t i = 0; i < structs.size(); i++) {
+        uint64_t mask = 0;
+        char hex[32];
+        for(size_t j = 0; j < structs[i].members.size(); j++) {
+            if ( structs[i].members[j].required == true ) {
+                mask |= static_cast<uint64_t>(1) << j;
+            }
+        }
+        snprintf(hex, sizeof(hex), " 0x%llxULL,", static_cast<unsigned long long>(mask));
+        code += hex;
+    }
+    code += " };\n            return masks[type];\n        }\n    }\n\n";
+
+    code += "    /** SAX handler for rapidjson Reader, decoding directly into " + root_name + ".\n";
+    code += "     *  Fails on type mismatch, or if a required member is missing. Unknown members are skipped.\n";
+    code += "     */\n";
+    code += "    class " + decoder + " {\n    public:\n";
+    code += "        explicit " + decoder + "(" + root_name + "& root) : root(&root), skip(0) {}\n\n";
+    code += "        /** Decodes next document into root. (frame-stack is reused) */\n";
+    code += "        void reset(" + root_name + "& root) { this->root = &root; stack.clear(); skip = 0; }\n\n";
+    write_values(code);
+    write_containers(root_name, code);
+    code += "\n    private:\n";
+    code += "        struct Frame {\n";
+    code += "            Frame(int type, void* target) : type(type), target(target), field(-1), seen(0) {}\n";
+    code += "            int type;           // struct, or array after structs.\n";
+    code += "            void* target;\n";
+    code += "            int field;          // member of current key. (-1 : skipped)\n";
+    code += "            uint64_t seen;      // members found.\n";
+    code += "        };\n\n";
+    code += "        static bool mark(Frame& f) { f.seen |= static_cast<uint64_t>(1) << f.field; return true; }\n\n";
+    code += "        static bool is_integer(double d) {\n";
+    code += "            return d >= -9223372036854775808.0 && d < 9223372036854775808.0 && d == static_cast<double>(static_cast<int64_t>(d));\n";
+    code += "        }\n\n";
+    code += "        " + root_name + "* root;\n";
+    code += "        std::vector<Frame> stack;\n";
+    code += "        size_t skip;            // depth in skipped value.\n";
+    code += "    };\n\n";
+}
+
+void CSchemaCodegen::write_values(std::string& code) const {
+    code += "        bool Null() {\n";
+    code += "            if ( skip != 0 ) return true;\n";
+    code += "            return stack.empty() == false && stack.back().type < " + to_string(structs.size()) +
+            " && stack.back().field == -1;\n";
+    code += "        }\n";
+    code += "        bool Int(int i) { return Int64(i); }\n";
+    code += "        bool Uint(unsigned u) { return Int64(u); }\n";
+    code += "        bool RawNumber(const char*, rapidjson::SizeType, bool) { return false; }\n";
+
+    for(size_t e = 0; e < sizeof(events) / sizeof(events[0]); e++) {
+        const Event& event = events[e];
+
+        code += "        " + std::string(event.signature) + " {\n";
+        if ( event.string != NULL ) {
+            code += "            (void)copy;\n";
+        }
+        code += "            if ( skip != 0 ) return true;\n";
+        code += "            if ( stack.empty() == true ) return false;\n";
+        code += "            Frame& f = stack.back();\n";
+        code += "            switch( f.type ) {\n";
+
+        for(size_t i = 0; i < structs.size(); i++) {
+            std::string cases;
+            for(size_t j = 0; j < structs[i].members.size(); j++) {
+                const Member& member = structs[i].members[j];
+                const char* check = NULL;
+                const char* value = value_of(event, member.type.kind, check);
+                if ( value == NULL ) {
+                    continue;
+                }
+                cases += "                case " + to_string(j) + ": " + (check ? std::string(check) + " " : "");
+                if ( member.type.kind == E_FIELD_TYPE::E_FIELD_TYPE_STRING ) {
+                    cases += "p->" + member.ident + ".assign(str, length); ";
+                }
+                else {
+                    cases += "p->" + member.ident + " = " + value + "; ";
+                }
+                if ( member.required == false ) {
+                    cases += "p->has_" + member.ident + " = true; ";
+                }
+                cases += "return mark(f);\n";
+            }
+            code += "            case " + to_string(i) + ": {\n";
+            if ( cases.empty() == false ) {
+                code += "                " + structs[i].name + "* p = static_cast<" + structs[i].name + "*>(f.target);\n";
+            }
+            code += "                switch( f.field ) {\n" + cases;
+            code += "                case -1: return true;\n";
+            code += "                }\n                return false;\n            }\n";
+        }
+        for(size_t i = 0; i < arrays.size(); i++) {
+            const char* check = NULL;
+            const char* value = value_of(event, arrays[i].kind, check);
+            if ( value == NULL ) {
+                continue;
+            }
+            const std::string vector = type_name(E_FIELD_TYPE::E_FIELD_TYPE_ARRAY, i);
+            code += "            case " + to_string(structs.size() + i) + ":\n";
+            if ( check != NULL ) {
+                code += "                " + std::string(check) + "\n";
+            }
+            code += "                static_cast<" + vector + "*>(f.target)->push_back(" + value + ");\n";
+            code += "                return true;\n";
+        }
+        code += "            }\n            return false;\n        }\n";
+    }
+}
+
+void CSchemaCodegen::write_containers(const std::string& root_name, std::string& code) const {
+    const std::string detail = "codegen_" + root_name;
+
+    code += "        bool Key(const char* str, rapidjson::SizeType length, bool copy) {\n";
+    code += "            (void)copy;\n";
+    code += "            if ( skip != 0 ) return true;\n";
+    code += "            Frame& f = stack.back();\n";
+    code += "            switch( f.type ) {\n";
+    for(size_t i = 0; i < structs.size(); i++) {
+        code += "            case " + to_string(i) + ": f.field = " + detail + "::find_" + structs[i].name +
+                "(str, length); return true;\n";
+    }
+    code += "            }\n            return false;\n        }\n";
+
+    // StartObject() opens struct, StartArray() opens array : of member or array-item.
+    for(size_t k = 0; k < 2; k++) {
+        const bool object = (k == 0);
+        const E_FIELD_TYPE kind = object ? E_FIELD_TYPE::E_FIELD_TYPE_OBJECT : E_FIELD_TYPE::E_FIELD_TYPE_ARRAY;
+
+        code += object ? "        bool StartObject() {\n" : "        bool StartArray() {\n";
+        code += "            if ( skip != 0 ) { skip++; return true; }\n";
+        if ( object == true ) {
+            code += "            if ( stack.empty() == true ) {\n";
+            code += "                *root = " + structs.back().name + "();\n";
+            code += "                stack.push_back(Frame(" + to_string(structs.size() - 1) + ", root));\n";
+            code += "                return true;\n";
+            code += "            }\n";
+        }
+        else {
+            code += "            if ( stack.empty() == true ) return false;\n";
+        }
+        code += "            Frame& f = stack.back();\n";
+        code += "            void* target = NULL;\n";
+        code += "            int type = 0;\n";
+        code += "            switch( f.type ) {\n";
+
+        for(size_t i = 0; i < structs.size(); i++) {
+            std::string cases;
+            for(size_t j = 0; j < structs[i].members.size(); j++) {
+                const Member& member = structs[i].members[j];
+                if ( member.type.kind != kind ) {
+                    continue;
+                }
+                const std::string field = "p->" + member.ident;
+                cases += "                case " + to_string(j) + ": ";
+                cases += object ? field + " = " + type_name(member.type) + "(); " : field + ".clear(); ";
+                if ( member.required == false ) {
+                    cases += "p->has_" + member.ident + " = true; ";
+                }
+                cases += "mark(f); target = &" + field + "; type = " + to_string(frame_type(member.type)) + "; break;\n";
+            }
+            code += "            case " + to_string(i) + ": {\n";
+            if ( cases.empty() == false ) {
+                code += "                " + structs[i].name + "* p = static_cast<" + structs[i].name + "*>(f.target);\n";
+            }
+            code += "                switch( f.field ) {\n" + cases;
+            code += "                case -1: skip = 1; return true;\n";
+            code += "                default: return false;\n";
+            code += "                }\n                break;\n            }\n";
+        }
+        for(size_t i = 0; i < arrays.size(); i++) {
+            if ( arrays[i].kind != kind ) {
+                continue;
+            }
+            const std::string vector = type_name(E_FIELD_TYPE::E_FIELD_TYPE_ARRAY, i);
+            code += "            case " + to_string(structs.size() + i) + ": {\n";
+            code += "                " + vector + "* v = static_cast<" + vector + "*>(f.target);\n";
+            code += "                v->push_back(" + type_name(arrays[i]) + "()); target = &v->back(); type = " +
+                    to_string(frame_type(arrays[i])) + "; break;\n";
+            code += "            }\n";
+        }
+        code += "            default: return false;\n";
+        code += "            }\n";
+        code += "            stack.push_back(Frame(type, target));\n";
+        code += "            return true;\n        }\n";
+    }
+
+    code += "        bool EndObject(rapidjson::SizeType) {\n";
+    code += "            if ( skip != 0 ) { skip--; return true; }\n";
+    code += "            const uint64_t required = " + detail + "::required_of(stack.back().type);\n";
+    code += "            if ( (stack.back().seen & required) != required ) return false;\n";
+    code += "            stack.pop_back();\n";
+    code += "            return true;\n        }\n";
+    code += "        bool EndArray(rapidjson::SizeType) {\n";
+    code += "            if ( skip != 0 ) { skip--; return true; }\n";
+    code += "            stack.pop_back();\n";
+    code += "            return true;\n        }\n";
+}
+
+void CSchemaCodegen::write_encoders(const std::string& root_name, std::string& code) const {
+    code += "    namespace codegen_" + root_name + "\n    {\n";
+    code += "        template <typename Writer> bool write_value(Writer& w, bool v) { return w.Bool(v); }\n";
+    code += "        template <typename Writer> bool write_value(Writer& w, int64_t v) { return w.Int64(v); }\n";
+    code += "        template <typename Writer> bool write_value(Writer& w, double v) { return w.Double(v); }\n";
+    code += "        template <typename Writer> bool write_value(Writer& w, const std::string& v) {\n";
+    code += "            return w.String(v.data(), static_cast<rapidjson::SizeType>(v.size()));\n";
+    code += "        }\n";
+    code += "        template <typename Writer, typename T> bool write_value(Writer& w, const std::vector<T>& v);\n";
+    for(size_t i = 0; i < structs.size(); i++) {
+        code += "        template <typename Writer> bool write_value(Writer& w, const " + structs[i].name + "& v);\n";
+    }
+    code += "\n";
+    code += "        template <typename Writer, typename T>\n";
+    code += "        bool write_value(Writer& w, const std::vector<T>& v) {\n";
+    code += "            if ( w.StartArray() == false ) return false;\n";
+    code += "            for(size_t i = 0; i < v.size(); i++) {\n";
+    code += "                if ( write_value(w, v[i]) == false ) return false;\n";
+    code += "            }\n";
+    code += "            return w.EndArray(static_cast<rapidjson::SizeType>(v.size()));\n";
+    code += "        }\n";
+
+    for(size_t i = 0; i < structs.size(); i++) {
+        const Struct& object = structs[i];
+
+        code += "\n        template <typename Writer>\n";
+        code += "        bool write_value(Writer& w, const " + object.name + "& v) {\n";
+        code += "            if ( w.StartObject() == false ) return false;\n";
+        for(size_t j = 0; j < object.members.size(); j++) {
+            const Member& member = object.members[j];
+            const std::string write = "w.Key(" + literal(member.name) + ", " + to_string(member.name.length()) +
+                                      ") == false || write_value(w, v." + member.ident + ") == false";
+            if ( member.required == true ) {
+                code += "            if ( " + write + " ) return false;\n";
+            }
+            else {
+                code += "            if ( v.has_" + member.ident + " == true && (" + write + ") ) return false;\n";
+            }
+        }
+        code += "            return w.EndObject();\n";
+        code += "        }\n";
+    }
+    code += "    }\n\n";
+}
+
+std::string CSchemaCodegen::unique_name(const std::string& name) {
+    std::string ret = identifier(name);
+
+    for(size_t i = 2; names.insert(ret).second == false; i++) {
+        ret = identifier(name) + to_string(i);
+    }
+    return ret;
+}
+
+std::string CSchemaCodegen::identifier(const std::string& name) {
+    std::string ret;
+
+    for(size_t i = 0; i < name.length(); i++) {
+        const unsigned char c = static_cast<unsigned char>(name[i]);
+        ret.push_back((isalnum(c) || c == '_') ? static_cast<char>(c) : '_');
+    }
+    if ( ret.empty() == true || isdigit(static_cast<unsigned char>(ret[0])) ) {
+        ret.insert(0, "_");
+    }
+    for(size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if ( ret == keywords[i] ) {
+            ret.push_back('_');
+            break;
+        }
+    }
+    return ret;
+}
+
+std::string CSchemaCodegen::camel(const std::string& name) {
+    std::string ret;
+    bool upper = true;
+
+    for(size_t i = 0; i < name.length(); i++) {
+        const unsigned char c = static_cast<unsigned char>(name[i]);
+        if ( isalnum(c) == 0 ) {
+            upper = true;
+            continue;
+        }
+        ret.push_back(upper ? static_cast<char>(toupper(c)) : static_cast<char>(c));
+        upper = false;
+    }
+    return ret;
+}
+
+std::string CSchemaCodegen::literal(const std::string& text) {
+    std::string ret = "\"";
+
+    for(size_t i = 0; i < text.length(); i++) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        if ( c == '"' || c == '\\' ) {
+            ret.push_back('\\');
+            ret.push_back(static_cast<char>(c));
+        }
+        else if ( c < 0x20 || c >= 0x7f ) {
+            // octal : not continued by following digits, unlike hex.
+            char oct[8];
+            snprintf(oct, sizeof(oct), "\\%03o", c);
+            ret += oct;
+        }
+        else {
+            ret.push_back(static_cast<char>(c));
+        }
+    }
+    ret.push_back('"');
+    return ret;
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
@@ -0,0 +1,110 @@
+#ifndef _C_JSON_CODEGEN_H_
+#define _C_JSON_CODEGEN_H_
+
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+#include <json_headers.h>
+#include <json_schema.h>
+#include <json_schema_plan.h>
+
+namespace json_mng
+{
+    /** Generates C++ code for documents of a schema. (used by tools/json_codegen.cpp)
+     *  Code has structs of object schemas, a SAX handler for Reader that decodes directly
+     *  into the structs, (switch on key-length and type, no DOM) and encoders for Writer.
+     *  Members of fixed type are generated : integer, number, boolean, string, object,
+     *  and array of those. Other members are skipped by the decoder.
+     *  Decoder fails on type mismatch, or if a required member is missing.
+     */
+    class CSchemaCodegen {
+    public:
+        CSchemaCodegen(std::shared_ptr<CJsonSchema> schema);
+
+        ~CSchemaCodegen(void);
+
+        /** Generates header code. Returns false if root is not an object schema,
+         *  or an object schema has too many properties. (max_members)
+         *  root_name : struct of root. name_space : namespace of code. (empty : global)
+         */
+        bool generate(const std::string& root_name, const std::string& name_space, std::string& code);
+
+    private:
+        /** Members are tracked by a 64-bit mask in decoder. */
+        static const size_t max_members = 64;
+
+        static const size_t max_depth = 32;
+
+        typedef struct Type {
+            E_FIELD_TYPE kind;
+            size_t index;           // struct of E_FIELD_TYPE_OBJECT, array of E_FIELD_TYPE_ARRAY.
+        } Type;
+
+        typedef struct Member {
+            std::string name;       // key in document.
+            std::string ident;      // member of struct. (optional one also has "has_<ident>" flag)
+            Type type;
+            bool required;
+        } Member;
+
+        typedef struct Struct {
+            std::string name;
+            std::vector<Member> members;
+        } Struct;
+
+        /** Adds struct of object schema after structs of it's members. (definition order) */
+        bool add_struct(const Value_Type& schema, const std::string& name, size_t depth, size_t& index);
+
+        /** Type of value schema. E_FIELD_TYPE_ANY if it is not generated. */
+        bool add_type(const Value_Type& schema, const std::string& name, size_t depth, Type& type);
+
+        /** Follows local "$ref". (NULL if not found) */
+        const Value_Type* resolve(const Value_Type& schema, size_t depth) const;
+
+        std::string type_name(const Type& type) const;
+
+        std::string type_name(E_FIELD_TYPE kind, size_t index) const;
+
+        /** Frame-type of decoder : structs, and arrays after them. */
+        size_t frame_type(const Type& type) const;
+
+        void write_structs(std::string& code) const;
+
+        /** Key lookups, and SAX handler with a frame per open object/array. */
+        void write_decoder(const std::string& root_name, std::string& code) const;
+
+        /** Scalar events of handler : stores value into member or array of top frame. */
+        void write_values(std::string& code) const;
+
+        /** Key and object/array events of handler : opens frame of member or array-item. */
+        void write_containers(const std::string& root_name, std::string& code) const;
+
+        void write_encoders(const std::string& root_name, std::string& code) const;
+
+        std::string unique_name(const std::string& name);
+
+        static std::string identifier(const std::string& name);
+
+        static std::string camel(const std::string& name);
+
+        static std::string literal(const std::string& text);
+
+    private:
+        std::shared_ptr<CJsonSchema> schema;
+
+        std::vector<Struct> structs;
+
+        std::vector<Type> arrays;               // item type of each array type.
+
+        std::set<std::string> names;            // struct names in use.
+
+        std::map<const Value_Type*, size_t> objects;    // struct of each object schema.
+
+    };
+}
+
+#endif // _C_JSON_CODEGEN_H_
@@ -0,0 +1,386 @@
+#include <cassert>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <set>
+
+#include <logger.h>
+#include <json_config_registry.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+namespace {
+
+/** Events of a file written in place, or renamed over. */
+const uint32_t watch_mask = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+/** Splits path into directory and name. ("." if path has no directory) */
+void split_path(const std::string& path, std::string& directory, std::string& name) {
+    const size_t slash = path.find_last_of('/');
+
+    if ( slash == std::string::npos ) {
+        directory = ".";
+        name = path;
+    }
+    else {
+        directory = (slash == 0) ? "/" : path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+std::string join_path(const std::string& directory, const char* name) {
+    return (directory == "/") ? directory + name : directory + "/" + name;
+}
+
+}
+
+/*******************************
+ * Public Function Definiction.
+ */
+CConfigRegistry::CConfigRegistry(void)
+: current(new Table()), epoch(1), inotify_fd(-1), stop_fd(-1) {
+    for(size_t i = 0; i < max_readers; i++) {
+        slots[i].epoch.store(0);
+    }
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if ( inotify_fd < 0 ) {
+        LOGERR("Can not init inotify.(errno=%d)", errno);
+    }
+    stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ( stop_fd < 0 ) {
+        LOGERR("Can not create eventfd.(errno=%d)", errno);
+    }
+}
+
+CConfigRegistry::~CConfigRegistry(void) {
+    stop();
+
+    for(size_t i = 0; i < retired.size(); i++) {
+        delete retired[i].table;
+    }
+    retired.clear();
+    delete current.exchange(NULL);
+
+    if ( inotify_fd >= 0 ) {
+        close(inotify_fd);
+    }
+    if ( stop_fd >= 0 ) {
+        close(stop_fd);
+    }
+}
+
+bool CConfigRegistry::add(const std::string& path) {
+    std::shared_ptr<const CFrozenJson> document;
+
+    if ( load(path, document) == false ) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if ( watch(path) == false ) {
+        return false;
+    }
+
+    Table* table = new Table(*current.load());
+    Config& config = table->configs[path];
+    config.document = document;
+    config.version++;
+    publish(table);
+    return true;
+}
+
+bool CConfigRegistry::reload(const std::string& path) {
+    std::shared_ptr<const CFrozenJson> document;
+
+    // parsed out of lock : add() of other files is not delayed.
+    if ( load(path, document) == false ) {
+        LOGW("Previous config is kept.(%s)", path.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    const Table* previous = current.load();
+    if ( previous->configs.find(path) == previous->configs.end() ) {
+        return false;
+    }
+
+    Table* table = new Table(*previous);
+    Config& config = table->configs[path];
+    config.document = document;
+    config.version++;
+    publish(table);
+    return true;
+}
+
+bool CConfigRegistry::start(void) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if ( inotify_fd < 0 || stop_fd < 0 ) {
+        return false;
+    }
+    if ( thread.joinable() == false ) {
+        thread = std::thread(&CConfigRegistry::run, this);
+    }
+    return true;
+}
+
+void CConfigRegistry::stop(void) {
+    const uint64_t one = 1;
+
+    if ( thread.joinable() == false ) {
+        return;
+    }
+    if ( write(stop_fd, &one, sizeof(one)) != sizeof(one) ) {
+        LOGERR("Can not wake background thread.(errno=%d)", errno);
+    }
+    thread.join();
+
+    // eventfd is cleared for next start().
+    uint64_t count = 0;
+    if ( read(stop_fd, &count, sizeof(count)) != sizeof(count) ) {
+        LOGW("Can not clear eventfd.(errno=%d)", errno);
+    }
+}
+
+std::shared_ptr<const CFrozenJson> CConfigRegistry::get_shared(const std::string& path) const {
+    std::shared_ptr<const CFrozenJson> ret;
+    const size_t slot = enter();
+    const Table* table = current.load();
+
+    std::map<std::string, Config>::const_iterator found = table->configs.find(path);
+    if ( found != table->configs.end() ) {
+        ret = found->second.document;
+    }
+    leave(slot);
+    return ret;
+}
+
+CConfigReader::CConfigReader(const CConfigRegistry& registry)
+: registry(registry), slot(registry.enter()), table(registry.current.load()) {
+}
+
+CConfigReader::~CConfigReader(void) {
+    registry.leave(slot);
+}
+
+CFrozenValue CConfigReader::get(const std::string& path) const {
+    std::map<std::string, CConfigRegistry::Config>::const_iterator found = table->configs.find(path);
+
+    if ( found == table->configs.end() ) {
+        return CFrozenValue();
+    }
+    return found->second.document->get_root();
+}
+
+uint64_t CConfigReader::get_version(const std::string& path) const {
+    std::map<std::string, CConfigRegistry::Config>::const_iterator found = table->configs.find(path);
+
+    if ( found == table->configs.end() ) {
+        return 0;
+    }
+    return found->second.version;
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+size_t CConfigRegistry::enter(void) const {
+    // threads start from different slots.
+    static thread_local size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    for(size_t i = 0; ; i++) {
+        const size_t slot = (hint + i) % max_readers;
+        uint64_t free = 0;
+
+        // epoch is announced before table is read. (seq_cst)
+        if ( slots[slot].epoch.load(std::memory_order_relaxed) == 0 &&
+             slots[slot].epoch.compare_exchange_strong(free, epoch.load()) == true ) {
+            hint = slot;
+            return slot;
+        }
+        // all slots are taken.
+        if ( (i + 1) % max_readers == 0 ) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void CConfigRegistry::leave(size_t slot) const {
+    slots[slot].epoch.store(0, std::memory_order_release);
+}
+
+void CConfigRegistry::publish(Table* table) {
+    Retired previous;
+
+    previous.table = current.exchange(table);
+    previous.epoch = epoch.fetch_add(1);
+    retired.push_back(previous);
+    reclaim();
+}
+
+void CConfigRegistry::reclaim(void) {
+    uint64_t oldest = UINT64_MAX;
+
+    // readers of older epochs may still see a table replaced in their epoch.
+    for(size_t i = 0; i < max_readers; i++) {
+        const uint64_t reader = slots[i].epoch.load();
+        if ( reader != 0 && reader < oldest ) {
+            oldest = reader;
+        }
+    }
+
+    size_t kept = 0;
+    for(size_t i = 0; i < retired.size(); i++) {
+        if ( retired[i].epoch < oldest ) {
+            delete retired[i].table;
+        }
+        else {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired.resize(kept);
+}
+
+bool CConfigRegistry::load(const std::string& path, std::shared_ptr<const CFrozenJson>& document) {
+    char buffer[4096];
+    std::string text;
+    ssize_t length = 0;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( fd < 0 ) {
+        LOGW("Can not open file.(%s, errno=%d)", path.c_str(), errno);
+        return false;
+    }
+    while( (length = read(fd, buffer, sizeof(buffer))) > 0 ) {
+        text.append(buffer, static_cast<size_t>(length));
+    }
+    close(fd);
+    if ( length < 0 ) {
+        LOGW("Can not read file.(%s, errno=%d)", path.c_str(), errno);
+        return false;
+    }
+
+    JsonManipulator parsed;
+    if ( parsed.Parse(text.c_str(), text.length()).HasParseError() == true ) {
+        LOGW("Can not parse config.(%s, offset=%zu)", path.c_str(), parsed.GetErrorOffset());
+        return false;
+    }
+    if ( parsed.IsObject() == false ) {
+        LOGW("Root of config is not an object.(%s)", path.c_str());
+        return false;
+    }
+    document = std::make_shared<CFrozenJson>(parsed);
+    return true;
+}
+
+bool CConfigRegistry::watch(const std::string& path) {
+    std::string directory;
+    std::string name;
+
+    if ( inotify_fd < 0 ) {
+        return false;
+    }
+    split_path(path, directory, name);
+
+    // same watch is returned for a directory watched already.
+    const int wd = inotify_add_watch(inotify_fd, directory.c_str(), watch_mask);
+    if ( wd < 0 ) {
+        LOGW("Can not watch directory.(%s, errno=%d)", directory.c_str(), errno);
+        return false;
+    }
+    directories[wd] = directory;
+    files[join_path(directory, name.c_str())] = path;
+    return true;
+}
+
+void CConfigRegistry::run(void) {
+    struct pollfd fds[2];
+
+    fds[0].fd = stop_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = inotify_fd;
+    fds[1].events = POLLIN;
+
+    while( true ) {
+        int timeout = -1;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if ( retired.empty() == false ) {
+                reclaim();
+            }
+            timeout = (retired.empty() == true) ? -1 : reclaim_interval;
+        }
+
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+        if ( poll(fds, 2, timeout) < 0 && errno != EINTR ) {
+            LOGERR("Can not poll inotify.(errno=%d)", errno);
+            return;
+        }
+        if ( (fds[0].revents & POLLIN) != 0 ) {
+            return;
+        }
+        if ( (fds[1].revents & POLLIN) != 0 ) {
+            on_events();
+        }
+    }
+}
+
+void CConfigRegistry::on_events(void) {
+    alignas(struct inotify_event) char buffer[4096];
+    std::set<std::string> changed;
+    bool overflow = false;
+    ssize_t length = 0;
+
+    while( (length = read(inotify_fd, buffer, sizeof(buffer))) > 0 ) {
+        std::lock_guard<std::mutex> guard(lock);
+
+        for(ssize_t pos = 0; pos < length; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + pos);
+            pos += sizeof(struct inotify_event) + event->len;
+
+            if ( (event->mask & IN_Q_OVERFLOW) != 0 ) {
+                overflow = true;
+                continue;
+            }
+            if ( (event->mask & IN_IGNORED) != 0 ) {
+                directories.erase(event->wd);
+                continue;
+            }
+            std::map<int, std::string>::const_iterator directory = directories.find(event->wd);
+            if ( event->len == 0 || directory == directories.end() ) {
+                continue;
+            }
+            std::map<std::string, std::string>::const_iterator file = files.find(join_path(directory->second, event->name));
+            if ( file != files.end() ) {
+                changed.insert(file->second);
+            }
+        }
+    }
+
+    // events are lost : every file may be changed.
+    if ( overflow == true ) {
+        std::lock_guard<std::mutex> guard(lock);
+        for(std::map<std::string, std::string>::const_iterator itr = files.begin(); itr != files.end(); itr++) {
+            changed.insert(itr->second);
+        }
+    }
+
+    // a file changed many times in a batch is parsed once.
+    for(std::set<std::string>::const_iterator itr = changed.begin(); itr != changed.end(); itr++) {
+        reload(*itr);
+    }
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
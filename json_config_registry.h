@@ -0,0 +1,152 @@
+#ifndef _C_JSON_CONFIG_REGISTRY_H_
+#define _C_JSON_CONFIG_REGISTRY_H_
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+#include <json_frozen.h>
+
+namespace json_mng
+{
+    /** Config files kept as frozen documents, reloaded when they are changed. (Linux inotify)
+     *  All configs are published together as one table by atomic pointer swap. Readers never
+     *  lock : a reader announces the epoch it entered, and replaced tables are freed only
+     *  after every reader that could see them has left. (epoch-based reclamation)
+     *  Changed files are parsed on a background thread, so a reload takes one parse.
+     *  A file that can not be parsed keeps the previous config.
+     */
+    class CConfigRegistry {
+    public:
+        CConfigRegistry(void);
+
+        /** No reader may be in a section of this registry. */
+        ~CConfigRegistry(void);
+
+        /** Loads file, and watches it's directory. (renamed-over files are also seen)
+         *  Returns false if file can not be parsed as an object, or watched.
+         */
+        bool add(const std::string& path);
+
+        /** Reloads file now. (ex: on SIGHUP) Returns false if path is not added, or file can not be parsed. */
+        bool reload(const std::string& path);
+
+        /** Starts reloading changed files on a background thread. */
+        bool start(void);
+
+        void stop(void);
+
+        /** Current config of path, held beyond a read section. (NULL if not added) */
+        std::shared_ptr<const CFrozenJson> get_shared(const std::string& path) const;
+
+    private:
+        friend class CConfigReader;
+
+        /** Readers in sections at the same time. More readers wait for a free slot. */
+        static const size_t max_readers = 128;
+
+        /** Interval of reclamation while replaced tables are left. (msec) */
+        static const int reclaim_interval = 100;
+
+        typedef struct Config {
+            std::shared_ptr<const CFrozenJson> document;
+            uint64_t version;           // count of loads.
+        } Config;
+
+        typedef struct Table {
+            std::map<std::string, Config> configs;
+        } Table;
+
+        typedef struct Retired {
+            const Table* table;
+            uint64_t epoch;             // epoch when it was replaced.
+        } Retired;
+
+        /** Epoch of a reader in section. (0 : free) One cache-line each. */
+        typedef struct alignas(64) Slot {
+            std::atomic<uint64_t> epoch;
+        } Slot;
+
+        /** Takes a slot with current epoch. Returns the slot. */
+        size_t enter(void) const;
+
+        void leave(size_t slot) const;
+
+        /** Publishes table, and retires previous one. (lock is held) */
+        void publish(Table* table);
+
+        /** Frees retired tables that no reader in section can see. (lock is held) */
+        void reclaim(void);
+
+        static bool load(const std::string& path, std::shared_ptr<const CFrozenJson>& document);
+
+        /** Watches directory of path. (lock is held) */
+        bool watch(const std::string& path);
+
+        void run(void);
+
+        /** Reads inotify events, and reloads changed files. */
+        void on_events(void);
+
+    private:
+        std::atomic<const Table*> current;
+
+        std::atomic<uint64_t> epoch;        // starts from 1.
+
+        mutable Slot slots[max_readers];
+
+        std::mutex lock;                    // for writers : add(), reload() and background thread.
+
+        std::vector<Retired> retired;
+
+        int inotify_fd;
+
+        int stop_fd;                        // eventfd to wake background thread.
+
+        std::map<int, std::string> directories;     // directory of each watch.
+
+        std::map<std::string, std::string> files;   // added path of each watched "directory/name".
+
+        std::thread thread;
+
+    };
+
+    /** Read section of a registry : configs read in it are one consistent table,
+     *  and they are not freed until the section ends. Never blocks. (up to max_readers)
+     *  Keep it short, and do not hold views after it. (use get_shared() for that)
+     */
+    class CConfigReader {
+    public:
+        CConfigReader(const CConfigRegistry& registry);
+
+        ~CConfigReader(void);
+
+        /** Root of config of path. Invalid view if path is not added. */
+        CFrozenValue get(const std::string& path) const;
+
+        /** Count of loads of path. (0 if not added) */
+        uint64_t get_version(const std::string& path) const;
+
+    private:
+        CConfigReader(const CConfigReader&) = delete;
+
+        CConfigReader& operator=(const CConfigReader&) = delete;
+
+    private:
+        const CConfigRegistry& registry;
+
+        size_t slot;
+
+        const CConfigRegistry::Table* table;
+
+    };
+}
+
+#endif // _C_JSON_CONFIG_REGISTRY_H_
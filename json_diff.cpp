@@ -0,0 +1,443 @@
+#include <cassert>
+#include <string.h>
+#include <algorithm>
+
+#include <logger.h>
+#include <json_diff.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+namespace {
+
+/** Objects up to this width are searched linearly. */
+const rapidjson::SizeType linear_members = 8;
+
+/** Type-tags of hash. */
+const uint64_t tag_null = 0x6e756c6cULL;
+const uint64_t tag_false = 0x66616c73ULL;
+const uint64_t tag_true = 0x74727565ULL;
+const uint64_t tag_number = 0x6e756d62ULL;
+const uint64_t tag_unsigned = 0x75696e74ULL;
+const uint64_t tag_string = 0x73747269ULL;
+const uint64_t tag_array = 0x61727261ULL;
+const uint64_t tag_object = 0x6f626a65ULL;
+
+/** Finalizer of MurmurHash3. */
+inline uint64_t fmix64(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+}
+
+/*******************************
+ * Public Function Definiction.
+ */
+CJsonDiff::CJsonDiff(void) : writer(NULL) {
+    path.clear();
+}
+
+CJsonDiff::~CJsonDiff(void) {
+    writer = NULL;
+}
+
+void CJsonDiff::diff(const Value_Type& source, const Value_Type& target, const E_DIFF format, Buffer_Type& buffer) {
+    source_side.hash.clear();
+    source_side.size.clear();
+    target_side.hash.clear();
+    target_side.size.clear();
+    build(source, source_side);
+    build(target, target_side);
+
+    Writer_Type patch_writer(buffer);
+    writer = &patch_writer;
+    path.clear();
+
+    if ( format == E_DIFF::E_DIFF_MERGE_PATCH ) {
+        if ( source.IsObject() == true && target.IsObject() == true ) {
+            merge_object(source, 0, target, 0);
+        }
+        else if ( same(source, 0, target, 0) == true ) {
+            writer->StartObject();
+            writer->EndObject();
+        }
+        else {
+            target.Accept(*writer);
+        }
+    }
+    else {
+        writer->StartArray();
+        diff_value(source, 0, target, 0);
+        writer->EndArray();
+    }
+    writer = NULL;
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+uint32_t CJsonDiff::build(const Value_Type& value, Side& side) {
+    const size_t node = side.hash.size();
+    uint64_t hash = 0;
+    uint32_t size = 1;
+
+    side.hash.push_back(0);
+    side.size.push_back(0);
+    switch( value.GetType() ) {
+    case rapidjson::kNullType:
+        hash = fmix64(tag_null);
+        break;
+    case rapidjson::kFalseType:
+        hash = fmix64(tag_false);
+        break;
+    case rapidjson::kTrueType:
+        hash = fmix64(tag_true);
+        break;
+    case rapidjson::kNumberType:
+        {
+            // integers are hashed exactly. (1 and 1.0 differ, and are replaced)
+            uint64_t tag = tag_number;
+            uint64_t bits = 0;
+            if ( value.IsInt64() == true ) {
+                bits = static_cast<uint64_t>(value.GetInt64());
+            }
+            else if ( value.IsUint64() == true ) {
+                // above INT64_MAX : same bits as a negative Int64.
+                tag = tag_unsigned;
+                bits = value.GetUint64();
+            }
+            else {
+                const double d = value.GetDouble();
+                memcpy(&bits, &d, sizeof(bits));
+                bits = rotl64(bits, 1) ^ 0x5555555555555555ULL;
+            }
+            hash = fmix64(tag ^ fmix64(bits));
+        }
+        break;
+    case rapidjson::kStringType:
+        hash = hash_string(value.GetString(), value.GetStringLength(), tag_string);
+        break;
+    case rapidjson::kArrayType:
+        hash = fmix64(tag_array ^ value.Size());
+        for(Value_Type::ConstValueIterator itr = value.Begin(); itr != value.End(); itr++) {
+            const size_t child = side.hash.size();
+            size += build(*itr, side);
+            hash = fmix64(hash ^ side.hash[child]) + child - node;
+        }
+        break;
+    case rapidjson::kObjectType:
+        {
+            // sum of members : independent of member order.
+            uint64_t sum = 0;
+            for(Value_Type::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); itr++) {
+                const size_t child = side.hash.size();
+                size += build(itr->value, side);
+                sum += fmix64(hash_string(itr->name.GetString(), itr->name.GetStringLength(), 0) ^
+                              rotl64(side.hash[child], 17));
+            }
+            hash = fmix64(tag_object ^ value.MemberCount()) + fmix64(sum);
+        }
+        break;
+    default:
+        break;
+    }
+    side.hash[node] = hash;
+    side.size[node] = size;
+    return size;
+}
+
+uint64_t CJsonDiff::hash_string(const char* str, size_t length, uint64_t seed) {
+    uint64_t hash = fmix64(seed ^ length);
+    uint64_t word = 0;
+    size_t i = 0;
+
+    for(; i + 8 <= length; i += 8) {
+        memcpy(&word, str + i, 8);
+        hash = rotl64(hash ^ (word * 0x87c37b91114253d5ULL), 31) * 0x4cf5ad432745937fULL;
+    }
+    word = 0;
+    memcpy(&word, str + i, length - i);
+    return fmix64(hash ^ word);
+}
+
+bool CJsonDiff::equal(const Value_Type& a, const Value_Type& b) {
+    if ( a.GetType() != b.GetType() ) {
+        return false;
+    }
+    switch( a.GetType() ) {
+    case rapidjson::kNumberType:
+        // exact as hash : 1 and 1.0 differ. (operator== of rapidjson does not)
+        if ( a.IsDouble() == true || b.IsDouble() == true ) {
+            return a.IsDouble() == b.IsDouble() && a.GetDouble() == b.GetDouble();
+        }
+        if ( a.IsInt64() == true && b.IsInt64() == true ) {
+            return a.GetInt64() == b.GetInt64();
+        }
+        return a.IsUint64() == true && b.IsUint64() == true && a.GetUint64() == b.GetUint64();
+    case rapidjson::kStringType:
+        return a.GetStringLength() == b.GetStringLength() &&
+               memcmp(a.GetString(), b.GetString(), a.GetStringLength()) == 0;
+    case rapidjson::kArrayType:
+        if ( a.Size() != b.Size() ) {
+            return false;
+        }
+        for(rapidjson::SizeType i = 0; i < a.Size(); i++) {
+            if ( equal(a[i], b[i]) == false ) {
+                return false;
+            }
+        }
+        return true;
+    case rapidjson::kObjectType:
+        if ( a.MemberCount() != b.MemberCount() ) {
+            return false;
+        }
+        for(rapidjson::SizeType i = 0; i < a.MemberCount(); i++) {
+            const Value_Type::Member& member = *(a.MemberBegin() + i);
+            // same order is usual : member at same position is tried first.
+            Value_Type::ConstMemberIterator found = b.MemberBegin() + i;
+            if ( (found->name == member.name) == false ) {
+                found = b.FindMember(member.name);
+            }
+            if ( found == b.MemberEnd() || equal(member.value, found->value) == false ) {
+                return false;
+            }
+        }
+        return true;
+    default:
+        return true;
+    }
+}
+
+bool CJsonDiff::same(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node) const {
+    return source_side.hash[a_node] == target_side.hash[b_node] && equal(a, b) == true;
+}
+
+void CJsonDiff::index_members(const Value_Type& object, size_t node, const Side& side, Members& members) {
+    const rapidjson::SizeType count = object.MemberCount();
+    size_t child = node + 1;
+
+    members.nodes.resize(count);
+    members.matched.assign(count, false);
+    for(rapidjson::SizeType i = 0; i < count; i++) {
+        members.nodes[i] = child;
+        child += side.size[child];
+    }
+
+    members.names.clear();
+    if ( count > linear_members ) {
+        members.names.resize(count);
+        for(rapidjson::SizeType i = 0; i < count; i++) {
+            const Value_Type& name = (object.MemberBegin() + i)->name;
+            members.names[i].hash = hash_string(name.GetString(), name.GetStringLength(), 0);
+            members.names[i].member = i;
+        }
+        std::sort(members.names.begin(), members.names.end());
+    }
+}
+
+rapidjson::SizeType CJsonDiff::find_member(const Value_Type& object, const Members& members, const Value_Type& name) {
+    if ( members.names.empty() == true ) {
+        for(rapidjson::SizeType i = 0; i < object.MemberCount(); i++) {
+            if ( (object.MemberBegin() + i)->name == name ) {
+                return i;
+            }
+        }
+        return object.MemberCount();
+    }
+
+    NameIndex key;
+    key.hash = hash_string(name.GetString(), name.GetStringLength(), 0);
+    key.member = 0;
+    std::vector<NameIndex>::const_iterator itr = std::lower_bound(members.names.begin(), members.names.end(), key);
+    for(; itr != members.names.end() && itr->hash == key.hash; itr++) {
+        if ( (object.MemberBegin() + itr->member)->name == name ) {
+            return itr->member;
+        }
+    }
+    return object.MemberCount();
+}
+
+void CJsonDiff::diff_value(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node) {
+    if ( same(a, a_node, b, b_node) == true ) {
+        return;
+    }
+    if ( a.IsObject() == true && b.IsObject() == true ) {
+        diff_object(a, a_node, b, b_node);
+    }
+    else if ( a.IsArray() == true && b.IsArray() == true ) {
+        diff_array(a, a_node, b, b_node);
+    }
+    else {
+        write_op("replace", &b);
+    }
+}
+
+void CJsonDiff::diff_object(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node) {
+    const size_t path_length = path.size();
+    size_t a_child = a_node + 1;
+    Members members;
+
+    index_members(b, b_node, target_side, members);
+    for(Value_Type::ConstMemberIterator itr = a.MemberBegin(); itr != a.MemberEnd(); itr++) {
+        const rapidjson::SizeType member = find_member(b, members, itr->name);
+
+        push_path(itr->name.GetString(), itr->name.GetStringLength());
+        if ( member == b.MemberCount() ) {
+            write_op("remove", NULL);
+        }
+        else {
+            members.matched[member] = true;
+            diff_value(itr->value, a_child, (b.MemberBegin() + member)->value, members.nodes[member]);
+        }
+        path.resize(path_length);
+        a_child += source_side.size[a_child];
+    }
+
+    for(rapidjson::SizeType i = 0; i < b.MemberCount(); i++) {
+        if ( members.matched[i] == false ) {
+            const Value_Type::Member& added = *(b.MemberBegin() + i);
+            push_path(added.name.GetString(), added.name.GetStringLength());
+            write_op("add", &added.value);
+            path.resize(path_length);
+        }
+    }
+}
+
+void CJsonDiff::diff_array(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node) {
+    const size_t path_length = path.size();
+    const rapidjson::SizeType a_count = a.Size();
+    const rapidjson::SizeType b_count = b.Size();
+    std::vector<size_t> a_nodes(a_count);
+    std::vector<size_t> b_nodes(b_count);
+
+    for(rapidjson::SizeType i = 0, child = a_node + 1; i < a_count; child += source_side.size[child], i++) {
+        a_nodes[i] = child;
+    }
+    for(rapidjson::SizeType i = 0, child = b_node + 1; i < b_count; child += target_side.size[child], i++) {
+        b_nodes[i] = child;
+    }
+
+    // common head and tail are not changed.
+    const rapidjson::SizeType shorter = std::min(a_count, b_count);
+    rapidjson::SizeType head = 0;
+    rapidjson::SizeType tail = 0;
+    while( head < shorter && same(a[head], a_nodes[head], b[head], b_nodes[head]) == true ) {
+        head++;
+    }
+    while( tail < shorter - head &&
+           same(a[a_count - 1 - tail], a_nodes[a_count - 1 - tail], b[b_count - 1 - tail], b_nodes[b_count - 1 - tail]) == true ) {
+        tail++;
+    }
+
+    // middle : pairs are compared, then rest of source is removed from the end, and rest of target is added.
+    const rapidjson::SizeType a_middle = a_count - head - tail;
+    const rapidjson::SizeType b_middle = b_count - head - tail;
+    const rapidjson::SizeType pairs = std::min(a_middle, b_middle);
+    for(rapidjson::SizeType i = head; i < head + pairs; i++) {
+        push_path(i);
+        diff_value(a[i], a_nodes[i], b[i], b_nodes[i]);
+        path.resize(path_length);
+    }
+    for(rapidjson::SizeType i = head + a_middle; i-- > head + pairs;) {
+        push_path(i);
+        write_op("remove", NULL);
+        path.resize(path_length);
+    }
+    for(rapidjson::SizeType i = head + pairs; i < head + b_middle; i++) {
+        push_path(i);
+        write_op("add", &b[i]);
+        path.resize(path_length);
+    }
+}
+
+void CJsonDiff::merge_object(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node) {
+    size_t a_child = a_node + 1;
+    Members members;
+
+    writer->StartObject();
+    index_members(b, b_node, target_side, members);
+    for(Value_Type::ConstMemberIterator itr = a.MemberBegin(); itr != a.MemberEnd(); itr++) {
+        const rapidjson::SizeType member = find_member(b, members, itr->name);
+
+        if ( member == b.MemberCount() ) {
+            writer->Key(itr->name.GetString(), itr->name.GetStringLength());
+            writer->Null();
+        }
+        else {
+            const Value_Type& value = (b.MemberBegin() + member)->value;
+            members.matched[member] = true;
+            if ( same(itr->value, a_child, value, members.nodes[member]) == false ) {
+                writer->Key(itr->name.GetString(), itr->name.GetStringLength());
+                if ( itr->value.IsObject() == true && value.IsObject() == true ) {
+                    merge_object(itr->value, a_child, value, members.nodes[member]);
+                }
+                else {
+                    value.Accept(*writer);
+                }
+            }
+        }
+        a_child += source_side.size[a_child];
+    }
+
+    for(rapidjson::SizeType i = 0; i < b.MemberCount(); i++) {
+        if ( members.matched[i] == false ) {
+            const Value_Type::Member& added = *(b.MemberBegin() + i);
+            writer->Key(added.name.GetString(), added.name.GetStringLength());
+            added.value.Accept(*writer);
+        }
+    }
+    writer->EndObject();
+}
+
+void CJsonDiff::write_op(const char* op, const Value_Type* value) {
+    writer->StartObject();
+    writer->Key("op");
+    writer->String(op);
+    writer->Key("path");
+    writer->String(path.data(), static_cast<rapidjson::SizeType>(path.size()));
+    if ( value != NULL ) {
+        writer->Key("value");
+        value->Accept(*writer);
+    }
+    writer->EndObject();
+}
+
+void CJsonDiff::push_path(const char* name, size_t length) {
+    path.push_back('/');
+    for(size_t i = 0; i < length; i++) {
+        // '~' -> "~0", '/' -> "~1"
+        if ( name[i] == '~' ) {
+            path.append("~0", 2);
+        }
+        else if ( name[i] == '/' ) {
+            path.append("~1", 2);
+        }
+        else {
+            path.push_back(name[i]);
+        }
+    }
+}
+
+void CJsonDiff::push_path(size_t index) {
+    char buffer[24];
+    const char* end = rapidjson::internal::u64toa(index, buffer);
+
+    path.push_back('/');
+    path.append(buffer, static_cast<size_t>(end - buffer));
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
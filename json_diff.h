@@ -0,0 +1,98 @@
+#ifndef _C_JSON_DIFF_H_
+#define _C_JSON_DIFF_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+
+namespace json_mng
+{
+    typedef enum E_DIFF {
+        E_DIFF_PATCH = 0,           // RFC 6902 JSON Patch. (default)
+        E_DIFF_MERGE_PATCH = 1,     // RFC 7386 JSON Merge Patch. (null value of target can not be expressed)
+    } E_DIFF;
+
+    /** Structural diff of two documents.
+     *  64-bit hashes of all subtrees of both sides are computed first. (pre-order arrays)
+     *  Subtrees with different hash are changed, so only changed subtrees are visited.
+     *  Subtrees with same hash are compared exactly before they are skipped. (no change is lost by collision)
+     *  Object-hash does not depend on member order. Arrays are compared after trimming
+     *  common head and tail, so an insertion or deletion does not change following elements.
+     */
+    class CJsonDiff {
+    public:
+        CJsonDiff(void);
+
+        ~CJsonDiff(void);
+
+        /** Writes patch that changes source to target, to buffer. */
+        void diff(const Value_Type& source, const Value_Type& target, const E_DIFF format, Buffer_Type& buffer);
+
+    private:
+        typedef rapidjson::Writer<Buffer_Type> Writer_Type;
+
+        /** Hash and node-count of subtrees in pre-order. */
+        typedef struct Side {
+            std::vector<uint64_t> hash;
+            std::vector<uint32_t> size;
+        } Side;
+
+        static uint32_t build(const Value_Type& value, Side& side);
+
+        static uint64_t hash_string(const char* str, size_t length, uint64_t seed);
+
+        /** Exact equality of values. (1 and 1.0 differ, member order does not matter) */
+        static bool equal(const Value_Type& a, const Value_Type& b);
+
+        /** Whether subtrees are same : same hash, and equal. */
+        bool same(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node) const;
+
+        /** Member index of target object by name-hash, for wide objects. */
+        typedef struct NameIndex {
+            uint64_t hash;
+            rapidjson::SizeType member;
+            bool operator<(const NameIndex& other) const { return hash < other.hash; }
+        } NameIndex;
+
+        /** Lookup table of members of target object. */
+        typedef struct Members {
+            std::vector<size_t> nodes;          // node of each member value.
+            std::vector<NameIndex> names;       // sorted. (empty for narrow object)
+            std::vector<bool> matched;
+        } Members;
+
+        static void index_members(const Value_Type& object, size_t node, const Side& side, Members& members);
+
+        /** Member index of name in object. (object.MemberCount() if not found) */
+        static rapidjson::SizeType find_member(const Value_Type& object, const Members& members, const Value_Type& name);
+
+        void diff_value(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node);
+
+        void diff_object(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node);
+
+        void diff_array(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node);
+
+        void merge_object(const Value_Type& a, size_t a_node, const Value_Type& b, size_t b_node);
+
+        void write_op(const char* op, const Value_Type* value);
+
+        void push_path(const char* name, size_t length);
+
+        void push_path(size_t index);
+
+    private:
+        Side source_side;
+
+        Side target_side;
+
+        Writer_Type* writer;
+
+        std::string path;               // JSON-Pointer of current value.
+
+    };
+}
+
+#endif // _C_JSON_DIFF_H_
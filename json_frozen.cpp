@@ -0,0 +1,164 @@
+#include <cassert>
+#include <string.h>
+
+#include <logger.h>
+#include <json_frozen.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+/*******************************
+ * Public Function Definiction.
+ */
+size_t CFrozenValue::size(void) const {
+    if ( is_object() == true ) {
+        return value->MemberCount();
+    }
+    if ( is_array() == true ) {
+        return value->Size();
+    }
+    return 0;
+}
+
+CFrozenValue CFrozenValue::get_member(const char* key, size_t length) const {
+    if ( is_object() == false ) {
+        return CFrozenValue();
+    }
+    return CFrozenValue(document, document->find_member(*value, key, length));
+}
+
+CFrozenValue CFrozenValue::get_item(size_t index) const {
+    if ( is_array() == false || index >= value->Size() ) {
+        return CFrozenValue();
+    }
+    return CFrozenValue(document, &(*value)[static_cast<rapidjson::SizeType>(index)]);
+}
+
+CFrozenValue CFrozenValue::find(const std::string& pointer) const {
+    Pointer_Type parsed(pointer.c_str(), pointer.length());
+    CFrozenValue ret = *this;
+
+    if ( parsed.IsValid() == false ) {
+        LOGW("Invalid JSON-Pointer.(%s)", pointer.c_str());
+        return CFrozenValue();
+    }
+    for(size_t i = 0; i < parsed.GetTokenCount() && ret.is_valid() == true; i++) {
+        const Pointer_Type::Token& token = parsed.GetTokens()[i];
+        if ( ret.is_array() == true ) {
+            ret = (token.index == rapidjson::kPointerInvalidIndex) ? CFrozenValue() : ret.get_item(token.index);
+        }
+        else {
+            ret = ret.get_member(token.name, token.length);
+        }
+    }
+    return ret;
+}
+
+CFrozenJson::CFrozenJson(JsonManipulator& source) {
+    document.Swap(source);
+    build(document);
+}
+
+CFrozenJson::CFrozenJson(const Value_Type& value) {
+    document.CopyFrom(value, document.GetAllocator());
+    build(document);
+}
+
+CFrozenJson::~CFrozenJson(void) {
+    indexes.clear();
+    slots.clear();
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+void CFrozenJson::build(const Value_Type& value) {
+    if ( value.IsObject() == true ) {
+        if ( value.MemberCount() >= index_min_members ) {
+            build_index(value);
+        }
+        for(Value_Type::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); itr++) {
+            build(itr->value);
+        }
+    }
+    else if ( value.IsArray() == true ) {
+        for(Value_Type::ConstValueIterator itr = value.Begin(); itr != value.End(); itr++) {
+            build(*itr);
+        }
+    }
+}
+
+void CFrozenJson::build_index(const Value_Type& object) {
+    const rapidjson::SizeType count = object.MemberCount();
+    const Value_Type::ConstMemberIterator members = object.MemberBegin();
+    Index index;
+    size_t size = 1;
+
+    // half empty at most : short probes.
+    while( size < static_cast<size_t>(count) * 2 ) {
+        size <<= 1;
+    }
+    index.offset = slots.size();
+    index.mask = static_cast<uint32_t>(size - 1);
+    slots.resize(slots.size() + size, 0);
+
+    for(rapidjson::SizeType i = 0; i < count; i++) {
+        const Value_Type& name = members[i].name;
+        uint32_t slot = hash(name.GetString(), name.GetStringLength()) & index.mask;
+
+        // first one of same name is found, like FindMember().
+        for(; slots[index.offset + slot] != 0; slot = (slot + 1) & index.mask) {
+            const Value_Type& other = members[slots[index.offset + slot] - 1].name;
+            if ( other.GetStringLength() == name.GetStringLength() &&
+                 memcmp(other.GetString(), name.GetString(), name.GetStringLength()) == 0 ) {
+                break;
+            }
+        }
+        if ( slots[index.offset + slot] == 0 ) {
+            slots[index.offset + slot] = i + 1;
+        }
+    }
+    indexes[&object] = index;
+}
+
+const Value_Type* CFrozenJson::find_member(const Value_Type& object, const char* key, size_t length) const {
+    const rapidjson::SizeType count = object.MemberCount();
+    const Value_Type::ConstMemberIterator members = object.MemberBegin();
+
+    if ( count < index_min_members ) {
+        for(rapidjson::SizeType i = 0; i < count; i++) {
+            if ( members[i].name.GetStringLength() == length && memcmp(members[i].name.GetString(), key, length) == 0 ) {
+                return &members[i].value;
+            }
+        }
+        return NULL;
+    }
+
+    std::unordered_map<const Value_Type*, Index>::const_iterator found = indexes.find(&object);
+    assert(found != indexes.end());
+    const Index& index = found->second;
+
+    for(uint32_t slot = hash(key, length) & index.mask; slots[index.offset + slot] != 0; slot = (slot + 1) & index.mask) {
+        const Value_Type::Member& member = members[slots[index.offset + slot] - 1];
+        if ( member.name.GetStringLength() == length && memcmp(member.name.GetString(), key, length) == 0 ) {
+            return &member.value;
+        }
+    }
+    return NULL;
+}
+
+uint32_t CFrozenJson::hash(const char* key, size_t length) {
+    uint32_t h = 2166136261u;
+
+    for(size_t i = 0; i < length; i++) {
+        h = (h ^ static_cast<unsigned char>(key[i])) * 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
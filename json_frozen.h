@@ -0,0 +1,130 @@
+#ifndef _C_JSON_FROZEN_H_
+#define _C_JSON_FROZEN_H_
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+
+namespace json_mng
+{
+    class CFrozenJson;
+
+    /** Read-only view of a value in a frozen document. (no refcount : two pointers)
+     *  Valid while the frozen document is held. Invalid view if value does not exist.
+     *  Accessors of value do not check type, like CPlanReader. (check is_xxx() first)
+     */
+    class CFrozenValue {
+    public:
+        CFrozenValue(void) : document(NULL), value(NULL) {}
+
+        CFrozenValue(const CFrozenJson* document, const Value_Type* value) : document(document), value(value) {}
+
+        bool is_valid(void) const { return value != NULL; }
+
+        bool is_null(void) const { return value != NULL && value->IsNull(); }
+
+        bool is_bool(void) const { return value != NULL && value->IsBool(); }
+
+        bool is_int64(void) const { return value != NULL && value->IsInt64(); }
+
+        bool is_number(void) const { return value != NULL && value->IsNumber(); }
+
+        bool is_string(void) const { return value != NULL && value->IsString(); }
+
+        bool is_object(void) const { return value != NULL && value->IsObject(); }
+
+        bool is_array(void) const { return value != NULL && value->IsArray(); }
+
+        bool get_bool(void) const { return value->IsTrue(); }
+
+        int64_t get_int64(void) const { return value->GetInt64(); }
+
+        double get_double(void) const { return value->GetDouble(); }
+
+        const char* get_string(void) const { return value->GetString(); }
+
+        size_t get_string_length(void) const { return value->GetStringLength(); }
+
+        /** Count of members or items. (0 for others) */
+        size_t size(void) const;
+
+        /** Member key of object. (indexed for large objects) */
+        CFrozenValue get_member(const char* key, size_t length) const;
+
+        CFrozenValue get_member(const std::string& key) const { return get_member(key.data(), key.length()); }
+
+        /** Item of array. */
+        CFrozenValue get_item(size_t index) const;
+
+        /** Value of JSON-Pointer relative to this value. (RFC 6901, ex: "/a/0/b") */
+        CFrozenValue find(const std::string& pointer) const;
+
+        /** Members of object. (for iteration) */
+        Value_Type::ConstMemberIterator member_begin(void) const { return value->MemberBegin(); }
+
+        Value_Type::ConstMemberIterator member_end(void) const { return value->MemberEnd(); }
+
+        /** Value for other readers. (ex: CPlanReader::bind(), Accept() of Writer) */
+        const Value_Type& get_value(void) const { return *value; }
+
+    private:
+        const CFrozenJson* document;
+
+        const Value_Type* value;
+
+    };
+
+    /** Immutable document, safe for concurrent reads from any threads without locks.
+     *  Nothing is built lazily : member indexes of large objects are built at construction,
+     *  and read API only reads. Share it by std::shared_ptr<const CFrozenJson> : the one
+     *  refcount is at the root, views of values (CFrozenValue) are not counted.
+     */
+    class CFrozenJson {
+    public:
+        /** Takes the document. (source is left null, without copy) */
+        CFrozenJson(JsonManipulator& source);
+
+        /** Copies value. */
+        CFrozenJson(const Value_Type& value);
+
+        ~CFrozenJson(void);
+
+        CFrozenValue get_root(void) const { return CFrozenValue(this, &document); }
+
+        /** Count of objects with member index. */
+        size_t get_index_count(void) const { return indexes.size(); }
+
+    private:
+        friend class CFrozenValue;
+
+        /** Objects with less members are searched linearly. */
+        static const rapidjson::SizeType index_min_members = 16;
+
+        typedef struct Index {
+            size_t offset;          // first slot.
+            uint32_t mask;          // slot count - 1.
+        } Index;
+
+        void build(const Value_Type& value);
+
+        void build_index(const Value_Type& object);
+
+        const Value_Type* find_member(const Value_Type& object, const char* key, size_t length) const;
+
+        static uint32_t hash(const char* key, size_t length);
+
+    private:
+        JsonManipulator document;
+
+        std::unordered_map<const Value_Type*, Index> indexes;       // index of each large object.
+
+        std::vector<uint32_t> slots;        // member + 1 of all indexes. (0 : empty)
+
+    };
+}
+
+#endif // _C_JSON_FROZEN_H_
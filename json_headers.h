@@ -2,15 +2,28 @@
 #define _C_JSON_HEADERS_SETTING_H_
 
 #ifdef JSON_LIB_RAPIDJSON
-    // mode-flag for annotation-allow json-format.
-    #define RAPIDJSON_PARSE_DEFAULT_FLAGS kParseCommentsFlag
+    // mode-flag for annotation-allow json-format, with correctly rounded double.
+    #define RAPIDJSON_PARSE_DEFAULT_FLAGS (kParseCommentsFlag | kParseFullPrecisionFlag)
+    // select SIMD scanning kernels by cpuid at runtime. (x86 only)
+    #ifndef RAPIDJSON_SIMD_DISPATCH
+    #define RAPIDJSON_SIMD_DISPATCH
+    #endif
 
     #include <rapidjson/document.h>
+    #include <rapidjson/reader.h>
+    #include <rapidjson/pointer.h>
+    #include <rapidjson/schema.h>
+    #include <rapidjson/writer.h>
+    #include <rapidjson/prettywriter.h>
+    #include <rapidjson/stringbuffer.h>
+    #include <rapidjson/iovecwritestream.h>
 
     namespace json_mng
     {
         /** for Json Parser. */
         using JsonManipulator = rapidjson::Document;
+        /** for SAX Parser. */
+        using Reader_Type = rapidjson::Reader;
         /** for Object. */
         using Object_Type = rapidjson::Value::Object;
         /** for Value. */
@@ -19,6 +32,16 @@
         using ValueIterator = rapidjson::Value::ValueIterator;
         /** for Object-members. */
         using MemberIterator = rapidjson::Value::MemberIterator;
+        /** for Allocator of Document. (MemoryPoolAllocator) */
+        using Allocator_Type = rapidjson::Document::AllocatorType;
+        /** for constant string referenced without copy. */
+        using StringRef_Type = rapidjson::Value::StringRefType;
+        /** for JSON-Pointer. (RFC 6901) */
+        using Pointer_Type = rapidjson::Pointer;
+        /** for Serialized-text. */
+        using Buffer_Type = rapidjson::StringBuffer;
+        /** for Compiled JSON-Schema. */
+        using SchemaDocument_Type = rapidjson::SchemaDocument;
     }
     
 #elif JSON_LIB_HLOHMANN
@@ -27,6 +27,20 @@ template std::shared_ptr<bool> CMjson::get<bool>(std::string &key);
 template std::shared_ptr<double> CMjson::get<double>(std::string &key);
 template std::shared_ptr<float> CMjson::get<float>(std::string &key);
 
+template void CMjson::set_member<std::string>(std::string key, const std::string& value);
+template void CMjson::set_member<int>(std::string key, const int& value);
+template void CMjson::set_member<long>(std::string key, const long& value);
+template void CMjson::set_member<bool>(std::string key, const bool& value);
+template void CMjson::set_member<double>(std::string key, const double& value);
+template void CMjson::set_member<float>(std::string key, const float& value);
+
+template void CMjson::push_back<std::string>(std::string key, const std::string& value);
+template void CMjson::push_back<int>(std::string key, const int& value);
+template void CMjson::push_back<long>(std::string key, const long& value);
+template void CMjson::push_back<bool>(std::string key, const bool& value);
+template void CMjson::push_back<double>(std::string key, const double& value);
+template void CMjson::push_back<float>(std::string key, const float& value);
+
 static const char* exception_switch(E_ERROR err_num) {
     switch(err_num) {
     case E_ERROR::E_NO_ERROR:
@@ -49,12 +63,22 @@ static const char* exception_switch(E_ERROR err_num) {
 /*******************************
  * Public Function Definiction.
  */
-CMjson::CMjson(void) : is_parsed(false) {
+CMjson::CMjson(void) 
+: is_parsed(false), parse_mode(E_PARSE_MODE::E_PARSE_MODE_RECURSIVE), max_depth(0), lazy_root(0), detached(false), allocator(NULL), root_value(NULL) {
     object.reset();
+    reader.reset();
+    structural.reset();
+    lazy_msg.reset();
+    allocator = &manipulator.GetAllocator();
+    root_value = &manipulator;
 }
 
-CMjson::CMjson(Object_Type value) : is_parsed(false) {
+CMjson::CMjson(Object_Type value) 
+: is_parsed(false), parse_mode(E_PARSE_MODE::E_PARSE_MODE_RECURSIVE), max_depth(0), lazy_root(0), detached(false), allocator(NULL), root_value(NULL) {
     object.reset();
+    reader.reset();
+    structural.reset();
+    lazy_msg.reset();
     object = std::make_shared<Object_Type>(value);
     is_parsed=true;
 }
@@ -62,34 +86,37 @@ CMjson::CMjson(Object_Type value) : is_parsed(false) {
 CMjson::~CMjson(void) {
     is_parsed = false;
     object.reset();
+    reader.reset();
+    structural.reset();
+    lazy_msg.reset();
 }
 
 bool CMjson::is_there(void) {
     return is_parsed;
 }
 
-bool CMjson::parse(std::string input_data, const E_PARSE arg_type) {
+bool CMjson::parse(std::string input_data, const E_PARSE arg_type, const E_PARSE_BACKEND backend) {
     try {
-        switch(arg_type) {
-        case E_PARSE::E_PARSE_FILE:
-            {
-                std::shared_ptr<CRawMessage> msg = file_read(input_data);
-                is_parsed = parse(msg);
-            }
-            break;
-        case E_PARSE::E_PARSE_MESSAGE:
-            {
-                std::shared_ptr<CRawMessage> msg = std::make_shared<CRawMessage>();
-                msg->set_new_msg(input_data.c_str(), input_data.length());
-                is_parsed = parse(msg);
-            }
-        default :
-            throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
-        }
+        std::shared_ptr<CRawMessage> msg = get_message(input_data, arg_type);
+        is_parsed = parse(msg, backend);
+    }
+    catch( const std::exception &e) {
+        LOGERR("%s", e.what());
+        throw;
+    }
+    return is_parsed;
+}
+
+bool CMjson::parse(std::string input_data, std::shared_ptr<CJsonSchema> schema, const E_PARSE arg_type) {
+    assert( schema.get() != NULL );
+
+    try {
+        std::shared_ptr<CRawMessage> msg = get_message(input_data, arg_type);
+        is_parsed = parse(msg, schema->get_document());
     }
     catch( const std::exception &e) {
-        LOGERR("%", e.what());
-        throw e;
+        LOGERR("%s", e.what());
+        throw;
     }
     return is_parsed;
 }
@@ -138,6 +165,23 @@ std::shared_ptr<CRawMessage> CMjson::file_read(std::string &json_file_path) {
     return msg;
 }
 
+std::shared_ptr<CRawMessage> CMjson::get_message(std::string &input_data, const E_PARSE arg_type) {
+    std::shared_ptr<CRawMessage> msg;
+
+    switch(arg_type) {
+    case E_PARSE::E_PARSE_FILE:
+        msg = file_read(input_data);
+        break;
+    case E_PARSE::E_PARSE_MESSAGE:
+        msg = std::make_shared<CRawMessage>();
+        msg->set_new_msg(input_data.c_str(), input_data.length());
+        break;
+    default :
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    return msg;
+}
+
 template<>
 inline std::string CMjson::get_data<std::string>(const char* data) {
     return std::string(data);
@@ -184,16 +228,182 @@ void CMjson::is_array_check(std::string &key) {
     }
 }
 
+void CMjson::mutable_check(void) {
+    if ( detached == true ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+}
+
 /***
  * Third-party library dependency function.
  */
 #ifdef JSON_LIB_RAPIDJSON
-bool CMjson::parse(std::shared_ptr<CRawMessage>& msg) {
+/** SAX handler that forwards events to Document with limitation of nesting-depth. */
+class CDepthLimitHandler {
+public:
+    CDepthLimitHandler(JsonManipulator& doc, size_t max_depth)
+    : doc(doc), depth(0), max_depth(max_depth) {}
+
+    bool Null(void) { return doc.Null(); }
+    bool Bool(bool b) { return doc.Bool(b); }
+    bool Int(int i) { return doc.Int(i); }
+    bool Uint(unsigned u) { return doc.Uint(u); }
+    bool Int64(int64_t i) { return doc.Int64(i); }
+    bool Uint64(uint64_t u) { return doc.Uint64(u); }
+    bool Double(double d) { return doc.Double(d); }
+    bool RawNumber(const char* str, rapidjson::SizeType length, bool copy) { return doc.RawNumber(str, length, copy); }
+    bool String(const char* str, rapidjson::SizeType length, bool copy) { return doc.String(str, length, copy); }
+    bool Key(const char* str, rapidjson::SizeType length, bool copy) { return doc.Key(str, length, copy); }
+    bool StartObject(void) { return enter() && doc.StartObject(); }
+    bool EndObject(rapidjson::SizeType count) { depth--; return doc.EndObject(count); }
+    bool StartArray(void) { return enter() && doc.StartArray(); }
+    bool EndArray(rapidjson::SizeType count) { depth--; return doc.EndArray(count); }
+
+private:
+    bool enter(void) {
+        depth++;
+        if ( max_depth != 0 && depth > max_depth ) {
+            LOGW("Nesting-depth exceeds limit.(%zu)", max_depth);
+            return false;
+        }
+        return true;
+    }
+
+    JsonManipulator& doc;
+    size_t depth;
+    const size_t max_depth;
+};
+
+/** Generator for Document::Populate() that drives Reader with selected parse-mode.
+ *  With schema, events pass through validator before Document. (stops at first violation)
+ */
+struct CParseGenerator {
+    typedef rapidjson::GenericSchemaValidator<SchemaDocument_Type, CDepthLimitHandler> Validator_Type;
+
+    CParseGenerator(const char* msg, E_PARSE_MODE mode, size_t max_depth, Reader_Type& reader,
+                    const SchemaDocument_Type* schema=NULL)
+    : msg(msg), mode(mode), max_depth(max_depth), reader(reader), schema(schema) {}
+
+    bool operator()(JsonManipulator& doc) {
+        CDepthLimitHandler handler(doc, max_depth);
+
+        if ( schema == NULL ) {
+            return parse(handler);
+        }
+
+        Validator_Type validator(*schema, handler);
+        if ( parse(validator) == false && validator.GetInvalidSchemaKeyword() != NULL ) {
+            Buffer_Type where;
+            validator.GetInvalidDocumentPointer().StringifyUriFragment(where);
+            LOGW("Schema violation.(keyword '%s' at %s)", validator.GetInvalidSchemaKeyword(), where.GetString());
+        }
+        return !result.IsError();
+    }
+
+    template <typename Handler>
+    bool parse(Handler& handler) {
+        rapidjson::StringStream stream(msg);
+
+        if ( mode == E_PARSE_MODE::E_PARSE_MODE_ITERATIVE ) {
+            result = reader.Parse<rapidjson::kParseDefaultFlags | rapidjson::kParseIterativeFlag>(stream, handler);
+        }
+        else {
+            result = reader.Parse<rapidjson::kParseDefaultFlags>(stream, handler);
+        }
+        return !result.IsError();
+    }
+
+    const char* msg;
+    const E_PARSE_MODE mode;
+    const size_t max_depth;
+    Reader_Type& reader;
+    const SchemaDocument_Type* schema;
+    rapidjson::ParseResult result;
+};
+
+/** Generator for Document::Populate() from one value of structural-index. */
+struct CValueGenerator {
+    CValueGenerator(CStructuralIndex& index, size_t pos, size_t max_depth)
+    : index(index), pos(pos), max_depth(max_depth), result(false) {}
+
+    bool operator()(JsonManipulator& doc) {
+        result = index.populate_value(doc, pos, max_depth);
+        return result;
+    }
+
+    CStructuralIndex& index;
+    size_t pos;
+    const size_t max_depth;
+    bool result;
+};
+
+/** Generator for Document::Populate() from structural-index. */
+struct CStructuralGenerator {
+    CStructuralGenerator(CStructuralIndex& index, size_t max_depth)
+    : index(index), max_depth(max_depth), result(false) {}
+
+    bool operator()(JsonManipulator& doc) {
+        result = index.populate(doc, max_depth);
+        return result;
+    }
+
+    CStructuralIndex& index;
+    const size_t max_depth;
+    bool result;
+};
+
+CMjson::CMjson(std::shared_ptr<CStructuralIndex> index, std::shared_ptr<CRawMessage> msg, size_t root, size_t max_depth)
+: is_parsed(false), parse_mode(E_PARSE_MODE::E_PARSE_MODE_RECURSIVE), max_depth(max_depth), lazy_root(root), detached(true), allocator(NULL), root_value(NULL) {
+    assert(index.get() != NULL && index->char_at(root) == '{');
+    object.reset();
+    reader.reset();
+    structural = index;
+    lazy_msg = msg;
+    manipulator.SetObject();
+    object = std::make_shared<Object_Type>(manipulator.GetObject());
+    allocator = &manipulator.GetAllocator();
+    root_value = &manipulator;
+    is_parsed = true;
+}
+
+void CMjson::set_parse_mode(const E_PARSE_MODE mode, const size_t max_depth) {
+    // iterative parser keeps 2 counters per nesting-level in it's stack.
+    static const size_t level_size = 2 * sizeof(rapidjson::SizeType);
+    static const size_t string_size = 256;
+
+    parse_mode = mode;
+    this->max_depth = max_depth;
+    reader.reset();
+    reader = std::make_shared<Reader_Type>((rapidjson::CrtAllocator*)NULL, 
+                                           max_depth * level_size + string_size);
+}
+
+bool CMjson::parse(std::shared_ptr<CRawMessage>& msg, const E_PARSE_BACKEND backend) {
     assert( msg.get() != NULL );
     const char* msg_const = (const char*)msg->get_msg_read_only();
 
-    if( manipulator.Parse(msg_const).HasParseError() ) {
-        return false;
+    lazy_msg.reset();
+    if ( backend == E_PARSE_BACKEND::E_PARSE_BACKEND_LAZY ) {
+        if ( parse_lazy(msg) == false ) {
+            return false;
+        }
+    }
+    else if ( backend == E_PARSE_BACKEND::E_PARSE_BACKEND_STRUCTURAL && 
+              parse_structural(msg_const) == true ) {
+        // done by structural-index parser.
+    }
+    // Reader also reports error of text rejected by structural-index parser. (ex: comments)
+    else if ( reader.get() == NULL ) {
+        if( manipulator.Parse(msg_const).HasParseError() ) {
+            return false;
+        }
+    }
+    else {
+        CParseGenerator generator(msg_const, parse_mode, max_depth, *reader.get());
+        manipulator.Populate(generator);
+        if( generator.result.IsError() ) {
+            return false;
+        }
     }
     assert(manipulator.IsObject());
     object.reset();
@@ -202,16 +412,151 @@ bool CMjson::parse(std::shared_ptr<CRawMessage>& msg) {
     return true;
 }
 
+bool CMjson::parse(std::shared_ptr<CRawMessage>& msg, const SchemaDocument_Type& schema) {
+    assert( msg.get() != NULL );
+    const char* msg_const = (const char*)msg->get_msg_read_only();
+    Reader_Type default_reader;
+
+    lazy_msg.reset();
+    CParseGenerator generator(msg_const, parse_mode, max_depth, 
+                              reader.get() == NULL ? default_reader : *reader.get(), &schema);
+    manipulator.Populate(generator);
+    if( generator.result.IsError() ) {
+        return false;
+    }
+    if ( manipulator.IsObject() == false ) {
+        LOGW("Root of message is not an object.");
+        return false;
+    }
+    object.reset();
+    object = std::make_shared<Object_Type>(manipulator.GetObject());
+
+    return true;
+}
+
+bool CMjson::parse_structural(const char* msg) {
+    assert( msg != NULL );
+
+    // index can be shared with lazy views of previous message.
+    if ( structural.get() == NULL || structural.use_count() > 1 ) {
+        structural = std::make_shared<CStructuralIndex>();
+    }
+    if ( structural->build(msg, strlen(msg)) == false ) {
+        return false;
+    }
+
+    CStructuralGenerator generator(*structural.get(), max_depth);
+    manipulator.Populate(generator);
+    return generator.result;
+}
+
+bool CMjson::parse_lazy(std::shared_ptr<CRawMessage>& msg) {
+    const char* msg_const = (const char*)msg->get_msg_read_only();
+
+    if ( structural.get() == NULL || structural.use_count() > 1 ) {
+        structural = std::make_shared<CStructuralIndex>();
+    }
+    // Only structure of text is checked here. Values are checked at first access.
+    if ( structural->build(msg_const, strlen(msg_const)) == false || 
+         structural->match_brackets() == false ) {
+        return false;
+    }
+    if ( structural->size() == 0 || structural->char_at(0) != '{' || 
+         structural->skip(0) != structural->size() ) {
+        return false;
+    }
+
+    // manipulator keeps materialized members.
+    manipulator.SetObject();
+    lazy_msg = msg;
+    lazy_root = 0;
+    return true;
+}
+
+bool CMjson::materialize(std::string &key) {
+    assert(is_lazy() == true);
+    size_t pos = 0;
+
+    if ( object->HasMember(key.c_str()) == true ) {
+        return true;
+    }
+    if ( structural->find_member(lazy_root, key.c_str(), key.length(), pos) == false ) {
+        return false;
+    }
+
+    JsonManipulator value(&manipulator.GetAllocator());
+    CValueGenerator generator(*structural.get(), pos, max_depth);
+    value.Populate(generator);
+    if ( generator.result == false ) {
+        LOGW("Invalid value of member.(%s)", key.c_str());
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+
+    Value_Type name(key.c_str(), static_cast<rapidjson::SizeType>(key.length()), manipulator.GetAllocator());
+    manipulator.AddMember(name, value, manipulator.GetAllocator());
+    return true;
+}
+
+void CMjson::materialize_all(void) {
+    assert(is_lazy() == true);
+    CValueGenerator generator(*structural.get(), lazy_root, max_depth);
+
+    manipulator.Populate(generator);
+    if ( generator.result == false ) {
+        LOGW("Invalid lazy object.");
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+    lazy_msg.reset();
+}
+
 bool CMjson::has_member(std::string &key) {
     assert(is_there() == true);
-    return object->HasMember(key.c_str());
+    size_t pos = 0;
+
+    if ( object->HasMember(key.c_str()) == true ) {
+        return true;
+    }
+    return is_lazy() && structural->find_member(lazy_root, key.c_str(), key.length(), pos);
 }
 
 bool CMjson::is_array(std::string &key) {
     assert(is_there() == true);
+    size_t pos = 0;
+
+    if ( is_lazy() == true && object->HasMember(key.c_str()) == false ) {
+        return structural->find_member(lazy_root, key.c_str(), key.length(), pos) && 
+               structural->char_at(pos) == '[';
+    }
     return (*object.get())[key.c_str()].IsArray();
 }
 
+template <typename T>
+std::shared_ptr<std::list<std::shared_ptr<T>>> CMjson::get_lazy_array(std::string &) {
+    throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+}
+
+template <>
+std::shared_ptr<std::list<std::shared_ptr<CMjson>>> CMjson::get_lazy_array<CMjson>(std::string &key) {
+    std::shared_ptr<std::list<std::shared_ptr<CMjson>>> ret = std::make_shared<std::list<std::shared_ptr<CMjson>>>();
+    size_t pos = 0;
+
+    if ( structural->find_member(lazy_root, key.c_str(), key.length(), pos) == false ) {
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+    const size_t end = structural->skip(pos) - 1;
+    for(pos++; pos < end; pos++) {
+        if ( structural->char_at(pos) != '{' ) {
+            throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+        }
+        ret->push_back(std::shared_ptr<CMjson>(new CMjson(structural, lazy_msg, pos, max_depth)));
+        pos = structural->skip(pos);
+        if ( pos < end && structural->char_at(pos) != ',' ) {
+            throw CException(E_ERROR::E_INVALID_VALUE);
+        }
+    }
+    return ret;
+}
+
 template <typename T>
 std::shared_ptr<std::list<std::shared_ptr<T>>> CMjson::get_array(std::string &key) {
     assert(is_there() == true);
@@ -222,6 +567,14 @@ std::shared_ptr<std::list<std::shared_ptr<T>>> CMjson::get_array(std::string &ke
         throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
     }
 
+    // elements of lazy object-array are also lazy.
+    if ( is_lazy() == true ) {
+        if ( std::is_same<T, CMjson>::value == true && object->HasMember(key.c_str()) == false ) {
+            return get_lazy_array<T>(key);
+        }
+        materialize(key);
+    }
+
     std::shared_ptr<std::list<std::shared_ptr<T>>> ret = std::make_shared<std::list<std::shared_ptr<T>>>();
     rapidjson::Value &target = (*object.get())[key.c_str()];
     ValueIterator itr = target.Begin();
@@ -234,12 +587,69 @@ std::shared_ptr<std::list<std::shared_ptr<T>>> CMjson::get_array(std::string &ke
 
 template <>
 std::shared_ptr<std::string> CMjson::get<std::string>(ValueIterator itr) {
+    if ( itr->IsString() == false ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
     return std::make_shared<std::string>(itr->GetString());
 }
 
 template <>
 std::shared_ptr<CMjson> CMjson::get<CMjson>(ValueIterator itr) {
-    return std::make_shared<CMjson>(itr->GetObject());
+    std::shared_ptr<CMjson> ret = std::make_shared<CMjson>(itr->GetObject());
+    ret->allocator = allocator;
+    ret->root_value = &(*itr);
+    ret->detached = detached;
+    return ret;
+}
+
+template <>
+bool CMjson::get_native<std::string>(Value_Type&, std::string&) {
+    return false;
+}
+
+template <>
+bool CMjson::get_native<int>(Value_Type& value, int& data) {
+    if ( value.IsInt() == false ) {
+        return false;
+    }
+    data = value.GetInt();
+    return true;
+}
+
+template <>
+bool CMjson::get_native<long>(Value_Type& value, long& data) {
+    if ( value.IsInt64() == false ) {
+        return false;
+    }
+    data = static_cast<long>(value.GetInt64());
+    return true;
+}
+
+template <>
+bool CMjson::get_native<bool>(Value_Type& value, bool& data) {
+    if ( value.IsBool() == false ) {
+        return false;
+    }
+    data = value.GetBool();
+    return true;
+}
+
+template <>
+bool CMjson::get_native<double>(Value_Type& value, double& data) {
+    if ( value.IsNumber() == false ) {
+        return false;
+    }
+    data = value.GetDouble();
+    return true;
+}
+
+template <>
+bool CMjson::get_native<float>(Value_Type& value, float& data) {
+    if ( value.IsNumber() == false ) {
+        return false;
+    }
+    data = static_cast<float>(value.GetDouble());
+    return true;
 }
 
 template <typename T>
@@ -252,7 +662,8 @@ std::shared_ptr<T> CMjson::get_second(MemberIterator itor) {
         assert(value != NULL);
         *(ret.get()) = get_data<T>(value);
     }
-    else {
+    // number and bool set by set_member().
+    else if ( get_native<T>(itor->value, *(ret.get())) == false ) {
         throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
     }
     return ret;
@@ -261,8 +672,11 @@ std::shared_ptr<T> CMjson::get_second(MemberIterator itor) {
 template <typename T>
 std::shared_ptr<T> CMjson::get(std::string &key) {
     assert(is_there() == true);
-    const char* value = NULL;
     std::shared_ptr<T> ret = std::make_shared<T>();
+
+    if ( is_lazy() == true ) {
+        materialize(key);
+    }
     rapidjson::Value::MemberIterator target = object->FindMember(key.c_str());
 
     if ( target == object->MemberEnd() ) {
@@ -275,22 +689,48 @@ std::shared_ptr<T> CMjson::get(std::string &key) {
 template <>
 std::shared_ptr<CMjson> CMjson::get<CMjson>(std::string &key) {
     assert(is_there() == true);
+    size_t pos = 0;
+
+    // nested object of lazy object is also lazy.
+    if ( is_lazy() == true && object->HasMember(key.c_str()) == false ) {
+        if ( structural->find_member(lazy_root, key.c_str(), key.length(), pos) == false ) {
+            throw CException(E_ERROR::E_INVALID_VALUE);
+        }
+        if ( structural->char_at(pos) != '{' ) {
+            throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+        }
+        return std::shared_ptr<CMjson>(new CMjson(structural, lazy_msg, pos, max_depth));
+    }
     rapidjson::Value::MemberIterator target = object->FindMember(key.c_str());
 
     if ( target == object->MemberEnd() ) {
         throw CException(E_ERROR::E_INVALID_VALUE);
     }
-    
-    return std::make_shared<CMjson>(target->value.GetObject());
+    if ( target->value.IsObject() == false ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+
+    // view shares the document, so values moved between them are not copied.
+    std::shared_ptr<CMjson> ret = std::make_shared<CMjson>(target->value.GetObject());
+    ret->allocator = allocator;
+    ret->root_value = &target->value;
+    ret->detached = detached;
+    return ret;
 }
 
 inline MemberIterator CMjson::get_begin_member(void) {
     assert(is_there() == true);
+    if ( is_lazy() == true ) {
+        materialize_all();
+    }
     return object.get()->MemberBegin();
 }
 
 inline MemberIterator CMjson::get_end_member(void) {
     assert(is_there() == true);
+    if ( is_lazy() == true ) {
+        materialize_all();
+    }
     return object.get()->MemberEnd();
 }
 
@@ -298,6 +738,405 @@ inline std::string CMjson::get_first_member(MemberIterator itor) {
     return itor->name.GetString();
 }
 
+template <typename T>
+static Value_Type make_value(const T& value, Allocator_Type&) {
+    return Value_Type(value);
+}
+
+template <>
+Value_Type make_value<std::string>(const std::string& value, Allocator_Type& allocator) {
+    return Value_Type(value.c_str(), static_cast<rapidjson::SizeType>(value.length()), allocator);
+}
+
+template <>
+Value_Type make_value<long>(const long& value, Allocator_Type&) {
+    return Value_Type(static_cast<int64_t>(value));
+}
+
+Allocator_Type& CMjson::get_allocator(void) {
+    assert(is_there() == true);
+
+    if ( is_lazy() == true ) {
+        materialize_all();
+    }
+    // object of unknown document. (ex: CMjson(Object_Type))
+    if ( allocator == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    return *allocator;
+}
+
+void CMjson::set_value(std::string &key, Value_Type &value) {
+    mutable_check();
+    Allocator_Type& alloc = get_allocator();
+    MemberIterator target = object->FindMember(key.c_str());
+
+    if ( target != object->MemberEnd() ) {
+        target->value = value;
+        return;
+    }
+    Value_Type name(key.c_str(), static_cast<rapidjson::SizeType>(key.length()), alloc);
+    object->AddMember(name, value, alloc);
+}
+
+void CMjson::push_value(std::string &key, Value_Type &value) {
+    mutable_check();
+    Allocator_Type& alloc = get_allocator();
+    MemberIterator target = object->FindMember(key.c_str());
+
+    if ( target == object->MemberEnd() ) {
+        Value_Type array(rapidjson::kArrayType);
+        array.PushBack(value, alloc);
+        set_value(key, array);
+        return;
+    }
+    if ( target->value.IsArray() == false ) {
+        throw CException(E_ERROR::E_ITS_NOT_ARRAY);
+    }
+    target->value.PushBack(value, alloc);
+}
+
+void CMjson::take_object(CMjson& value, Value_Type& target) {
+    // checked before members of value are moved out.
+    mutable_check();
+    Allocator_Type& alloc = get_allocator();
+
+    if ( &value == this ) {
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+    target.SetObject();
+    for(MemberIterator itr = value.get_begin_member(); itr != value.get_end_member(); itr++) {
+        if ( value.allocator == &alloc ) {
+            // moves name and value. (no copy)
+            target.AddMember(itr->name, itr->value, alloc);
+        }
+        else {
+            Value_Type name(itr->name, alloc);
+            Value_Type data(itr->value, alloc);
+            target.AddMember(name, data, alloc);
+        }
+    }
+    value.object->RemoveAllMembers();
+}
+
+template <typename T>
+void CMjson::set_member(std::string key, const T& value) {
+    Value_Type data = make_value<T>(value, get_allocator());
+    set_value(key, data);
+}
+
+void CMjson::set_member(std::string key, const char* value) {
+    Value_Type data(value, static_cast<rapidjson::SizeType>(strlen(value)), get_allocator());
+    set_value(key, data);
+}
+
+void CMjson::set_member(std::string key, StringRef_Type value) {
+    Value_Type data(value);
+    set_value(key, data);
+}
+
+void CMjson::set_member(std::string key, CMjson& value) {
+    Value_Type data;
+    take_object(value, data);
+    set_value(key, data);
+}
+
+bool CMjson::erase_member(std::string key) {
+    mutable_check();
+    get_allocator();
+    return object->EraseMember(key.c_str());
+}
+
+template <typename T>
+void CMjson::push_back(std::string key, const T& value) {
+    Value_Type data = make_value<T>(value, get_allocator());
+    push_value(key, data);
+}
+
+void CMjson::push_back(std::string key, const char* value) {
+    Value_Type data(value, static_cast<rapidjson::SizeType>(strlen(value)), get_allocator());
+    push_value(key, data);
+}
+
+void CMjson::push_back(std::string key, StringRef_Type value) {
+    Value_Type data(value);
+    push_value(key, data);
+}
+
+void CMjson::push_back(std::string key, CMjson& value) {
+    Value_Type data;
+    take_object(value, data);
+    push_value(key, data);
+}
+
+std::shared_ptr<CMjson> CMjson::emplace_object(std::string key) {
+    Value_Type data(rapidjson::kObjectType);
+    set_value(key, data);
+
+    Value_Type& target = object->FindMember(key.c_str())->value;
+    std::shared_ptr<CMjson> ret = std::make_shared<CMjson>(target.GetObject());
+    ret->allocator = allocator;
+    ret->root_value = &target;
+    return ret;
+}
+
+bool CMjson::apply_patch(CJsonPatch& patch) {
+    mutable_check();
+    Allocator_Type& alloc = get_allocator();
+
+    if ( root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    return patch.apply(*root_value, alloc);
+}
+
+std::string CMjson::diff(CMjson& target, const E_DIFF format) {
+    CJsonDiff engine;
+    Buffer_Type buffer;
+
+    // materializes lazy objects of both sides.
+    get_allocator();
+    target.get_allocator();
+    if ( root_value == NULL || target.root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    engine.diff(*root_value, *target.root_value, format, buffer);
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+/** value is inner, or inner is in value. */
+static bool is_within(const Value_Type& value, const Value_Type& inner) {
+    if ( &value == &inner ) {
+        return true;
+    }
+    if ( value.IsObject() == true ) {
+        for(Value_Type::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); itr++) {
+            if ( is_within(itr->value, inner) == true ) {
+                return true;
+            }
+        }
+    }
+    else if ( value.IsArray() == true ) {
+        for(Value_Type::ConstValueIterator itr = value.Begin(); itr != value.End(); itr++) {
+            if ( is_within(*itr, inner) == true ) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void CMjson::merge_patch(CMjson& patch) {
+    mutable_check();
+    Allocator_Type& alloc = get_allocator();
+
+    if ( &patch == this ) {
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+    patch.get_allocator();
+    if ( root_value == NULL || patch.root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+
+    if ( patch.allocator != &alloc ) {
+        CJsonMergePatch::apply(*root_value, *patch.root_value, alloc, false);
+        return;
+    }
+    // patch in the same document, disjoint from this object : values are moved.
+    if ( is_within(*root_value, *patch.root_value) == false && is_within(*patch.root_value, *root_value) == false ) {
+        CJsonMergePatch::apply(*root_value, *patch.root_value, alloc, true);
+        patch.object->RemoveAllMembers();
+        return;
+    }
+    // patch overlaps this object : it may be moved while members of this object grow.
+    Value_Type copy(*patch.root_value, alloc);
+    CJsonMergePatch::apply(*root_value, copy, alloc, true);
+}
+
+std::string CMjson::canonical(void) {
+    get_allocator();
+    if ( root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+
+    dump_buf.Clear();
+    if ( CJsonCanonical::write(*root_value, dump_buf) == false ) {
+        LOGW("Can not serialize value.(ex: NaN or Inf)");
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+    return std::string(dump_buf.GetString(), dump_buf.GetSize());
+}
+
+Hash128 CMjson::content_hash(void) {
+    get_allocator();
+    if ( root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    return CContentHash::hash(*root_value);
+}
+
+void CMjson::bind(CPlanReader& reader) {
+    get_allocator();
+    if ( root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    reader.bind(*root_value);
+}
+
+std::shared_ptr<const CFrozenJson> CMjson::freeze(void) {
+    std::shared_ptr<const CFrozenJson> ret;
+
+    // lazy object is parsed here.
+    get_allocator();
+    if ( root_value == NULL ) {
+        throw CException(E_ERROR::E_ITS_NOT_SUPPORTED_TYPE);
+    }
+    if ( root_value != &manipulator ) {
+        return std::make_shared<CFrozenJson>(*root_value);
+    }
+
+    ret = std::make_shared<CFrozenJson>(manipulator);
+    // allocator of document is moved with it.
+    allocator = &manipulator.GetAllocator();
+    object.reset();
+    is_parsed = false;
+    return ret;
+}
+
+/** Serialized length of string with quotes and escapes of Writer. */
+static size_t estimate_string_size(const char* str, size_t length) {
+    size_t size = length + 2;
+
+    for(size_t i = 0; i < length; i++) {
+        const unsigned char c = static_cast<unsigned char>(str[i]);
+        if ( c < 0x20 ) {
+            // \b \f \n \r \t or \u00XX
+            size += (c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') ? 1 : 5;
+        }
+        else if ( c == '"' || c == '\\' ) {
+            size += 1;
+        }
+    }
+    return size;
+}
+
+static size_t estimate_value_size(const Value_Type& value, const E_DUMP format, size_t depth) {
+    // indent of PrettyWriter, and ',' + new-line or ': ' per element.
+    const size_t indent = (format == E_DUMP::E_DUMP_PRETTY) ? 4 * (depth + 1) + 4 : 1;
+    size_t size = 0;
+
+    switch( value.GetType() ) {
+    case rapidjson::kNullType:
+    case rapidjson::kTrueType:
+        return 4;
+    case rapidjson::kFalseType:
+        return 5;
+    case rapidjson::kStringType:
+        return estimate_string_size(value.GetString(), value.GetStringLength());
+    case rapidjson::kNumberType:
+        if ( value.IsDouble() == true ) {
+            return 25;      // buffer-size of Writer::WriteDouble().
+        }
+        if ( value.IsUint64() == true ) {
+            return rapidjson::internal::DecimalLength64(value.GetUint64());
+        }
+        return 1 + rapidjson::internal::DecimalLength64(~static_cast<uint64_t>(value.GetInt64()) + 1);
+    case rapidjson::kObjectType:
+        size = 3 + 4 * depth;
+        for(Value_Type::ConstMemberIterator itr = value.MemberBegin(); itr != value.MemberEnd(); itr++) {
+            size += indent + 2 + estimate_string_size(itr->name.GetString(), itr->name.GetStringLength())
+                  + estimate_value_size(itr->value, format, depth + 1);
+        }
+        return size;
+    case rapidjson::kArrayType:
+        size = 3 + 4 * depth;
+        for(Value_Type::ConstValueIterator itr = value.Begin(); itr != value.End(); itr++) {
+            size += indent + estimate_value_size(*itr, format, depth + 1);
+        }
+        return size;
+    default:
+        return 0;
+    }
+}
+
+size_t CMjson::estimate_dump_size(const E_DUMP format) {
+    const size_t indent = (format == E_DUMP::E_DUMP_PRETTY) ? 4 + 4 : 1;
+    size_t size = 3;
+
+    for(MemberIterator itr = get_begin_member(); itr != get_end_member(); itr++) {
+        size += indent + 2 + estimate_string_size(itr->name.GetString(), itr->name.GetStringLength())
+              + estimate_value_size(itr->value, format, 1);
+    }
+    return size;
+}
+
+template <typename Writer>
+bool CMjson::write_object(Writer& writer) {
+    bool ret = writer.StartObject();
+
+    for(MemberIterator itr = get_begin_member(); ret == true && itr != get_end_member(); itr++) {
+        ret = writer.Key(itr->name.GetString(), itr->name.GetStringLength()) && itr->value.Accept(writer);
+    }
+    return ret && writer.EndObject();
+}
+
+std::string CMjson::dump(const E_DUMP format) {
+    dump_buf.Clear();
+    if ( dump_to(dump_buf, format) == false ) {
+        throw CException(E_ERROR::E_INVALID_VALUE);
+    }
+    return std::string(dump_buf.GetString(), dump_buf.GetSize());
+}
+
+bool CMjson::dump_to(Buffer_Type& buffer, const E_DUMP format) {
+    assert(is_there() == true);
+    const size_t start = buffer.GetSize();
+    bool ret = false;
+
+    // lazy object is parsed here, before estimation.
+    buffer.Reserve(estimate_dump_size(format));
+    if ( format == E_DUMP::E_DUMP_PRETTY ) {
+        rapidjson::PrettyWriter<Buffer_Type> writer(buffer);
+        ret = write_object(writer);
+    }
+    else {
+        rapidjson::Writer<Buffer_Type> writer(buffer);
+        ret = write_object(writer);
+    }
+
+    if ( ret == false ) {
+        LOGW("Can not serialize value.(ex: NaN or Inf)");
+        buffer.Pop(buffer.GetSize() - start);
+    }
+    return ret;
+}
+
+bool CMjson::dump_to_fd(int fd, const E_DUMP format) {
+    assert(is_there() == true);
+    // long strings are written from the document by writev(), without copy.
+    rapidjson::IovecWriteStream stream(fd);
+    bool ret = false;
+
+    if ( format == E_DUMP::E_DUMP_PRETTY ) {
+        rapidjson::PrettyWriter<rapidjson::IovecWriteStream> writer(stream);
+        ret = write_object(writer);
+    }
+    else {
+        rapidjson::Writer<rapidjson::IovecWriteStream> writer(stream);
+        ret = write_object(writer);
+    }
+
+    if ( ret == false ) {
+        LOGW("Can not serialize value.(ex: NaN or Inf)");
+        return false;
+    }
+    if ( stream.HasError() == true ) {
+        LOGERR("Can not write to fd.(%d, errno=%d)", fd, stream.GetError());
+        return false;
+    }
+    return true;
+}
+
 #elif JSON_LIB_HLOHMANN
     // TODO
 #endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
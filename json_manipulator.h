@@ -8,6 +8,16 @@
 
 #include <CRawMessage.h>
 #include <json_headers.h>
+#include <json_structural_index.h>
+#include <json_patch.h>
+#include <json_diff.h>
+#include <json_canonical.h>
+#include <json_schema.h>
+#include <json_schema_plan.h>
+#include <json_schema_batch.h>
+#include <json_binding.h>
+#include <json_frozen.h>
+#include <json_config_registry.h>
 
 namespace json_mng
 {
@@ -25,6 +35,22 @@ namespace json_mng
         E_PARSE_MESSAGE = 2,
     } E_PARSE;
 
+    typedef enum E_PARSE_MODE {
+        E_PARSE_MODE_RECURSIVE = 0,     // recursive descent parser. (default)
+        E_PARSE_MODE_ITERATIVE = 1,     // iterative parser with bounded call-stack.
+    } E_PARSE_MODE;
+
+    typedef enum E_PARSE_BACKEND {
+        E_PARSE_BACKEND_READER = 0,         // rapidjson Reader. (default)
+        E_PARSE_BACKEND_STRUCTURAL = 1,     // two-stage structural-index parser. (no comment)
+        E_PARSE_BACKEND_LAZY = 2,           // structural-index only. member is parsed at first access. (no comment, read-only object views)
+    } E_PARSE_BACKEND;
+
+    typedef enum E_DUMP {
+        E_DUMP_COMPACT = 0,     // no white-space. (default)
+        E_DUMP_PRETTY = 1,      // new-line and 4-space indent.
+    } E_DUMP;
+
     class CMjson {
     public:
         CMjson(void);
@@ -35,7 +61,31 @@ namespace json_mng
 
         bool is_there(void);
 
-        bool parse(std::string input_data, const E_PARSE arg_type=E_PARSE::E_PARSE_FILE);
+        bool parse(std::string input_data, const E_PARSE arg_type=E_PARSE::E_PARSE_FILE,
+                   const E_PARSE_BACKEND backend=E_PARSE_BACKEND::E_PARSE_BACKEND_READER);
+
+        /** Parses with validation by schema during parsing. (Reader backend)
+         *  Fails at the first violation, without building rest of the DOM.
+         */
+        bool parse(std::string input_data, std::shared_ptr<CJsonSchema> schema, const E_PARSE arg_type=E_PARSE::E_PARSE_FILE);
+
+        /** Select parser for next parse() call.
+         *  max_depth : maximum nesting-depth of object/array. (0 : unlimited)
+         *  Parse-stack of iterative parser is preallocated by max_depth.
+         */
+        void set_parse_mode(const E_PARSE_MODE mode, const size_t max_depth=default_max_depth);
+
+        /** Serializes this object to text. */
+        std::string dump(const E_DUMP format=E_DUMP::E_DUMP_COMPACT);
+
+        /** Appends serialized text to buffer. Returns false if a value can not be written. (ex: NaN) */
+        bool dump_to(Buffer_Type& buffer, const E_DUMP format=E_DUMP::E_DUMP_COMPACT);
+
+        /** Writes serialized text to fd by writev(). Long strings are not copied.
+         *  Returns false if a value can not be written or writev() fails.
+         *  Text already written before a NaN/Inf value is not rolled back.
+         */
+        bool dump_to_fd(int fd, const E_DUMP format=E_DUMP::E_DUMP_COMPACT);
 
         MemberIterator begin(void);
 
@@ -58,12 +108,96 @@ namespace json_mng
             return get_array<T>(key);
         }
 
+        /** Adds member key, or replaces its value. String is copied into the document once.
+         *  T : std::string, int, long, bool, double, float
+         *  Mutators throw E_ITS_NOT_SUPPORTED_TYPE on an object view of a lazy document. (E_PARSE_BACKEND_LAZY)
+         *  The view has it's own document, so changes of it would not be seen by the parent.
+         */
+        template <typename T>
+        void set_member(std::string key, const T& value);
+
+        void set_member(std::string key, const char* value);
+
+        /** String is referenced without copy. value must outlive this document. */
+        void set_member(std::string key, StringRef_Type value);
+
+        /** Moves members of value into member key, and value is left empty.
+         *  Members are copied only if value does not share the allocator of this document.
+         */
+        void set_member(std::string key, CMjson& value);
+
+        /** Removes member key keeping order of other members. Returns false if key is not a member. */
+        bool erase_member(std::string key);
+
+        /** Appends value to array member key. The array is created if key is not a member. */
+        template <typename T>
+        void push_back(std::string key, const T& value);
+
+        void push_back(std::string key, const char* value);
+
+        void push_back(std::string key, StringRef_Type value);
+
+        void push_back(std::string key, CMjson& value);
+
+        /** Sets member key to an empty object, and returns a view of it to be filled in place. */
+        std::shared_ptr<CMjson> emplace_object(std::string key);
+
+        /** Applies compiled JSON Patch in place. Returns false and leaves this object unchanged on failure. */
+        bool apply_patch(CJsonPatch& patch);
+
+        /** Returns patch that changes this object to target. (RFC 6902 or RFC 7386) */
+        std::string diff(CMjson& target, const E_DIFF format=E_DIFF::E_DIFF_PATCH);
+
+        /** Merges patch into this object in place. (RFC 7386)
+         *  If patch shares the allocator of this object and is disjoint from it, values are moved
+         *  and patch is left empty. Otherwise values are copied and patch is not changed.
+         *  (ex: patch of other document, or a view of a member of this object)
+         */
+        void merge_patch(CMjson& patch);
+
+        /** Canonical text of this object. (sorted members, normalized numbers, no white-space) */
+        std::string canonical(void);
+
+        /** Content hash of this object : same for objects with same canonical text. */
+        Hash128 content_hash(void);
+
+        /** Binds reader to this object, for unchecked reads of fields known by schema.
+         *  This object must be valid for schema of the plan. (ex: parsed with it)
+         */
+        void bind(CPlanReader& reader);
+
+        /** Immutable document of this object, for lock-free concurrent reads. (see CFrozenJson)
+         *  Document of this object is moved without copy, and this object is left empty. (is_there() is false)
+         *  Views of members of this object must not be used after it.
+         *  A view (ex: get_member<CMjson>()) is copied instead, and it's document is not changed.
+         */
+        std::shared_ptr<const CFrozenJson> freeze(void);
+
     private:
+        /** Lazy view of the object at root'th structural of index. (detached : read-only) */
+        CMjson(std::shared_ptr<CStructuralIndex> index, std::shared_ptr<CRawMessage> msg, size_t root, size_t max_depth);
+
         std::shared_ptr<CRawMessage> file_read(std::string &json_file_path);
 
+        std::shared_ptr<CRawMessage> get_message(std::string &input_data, const E_PARSE arg_type);
+
         void validation_check(std::string& key);
 
-        bool parse(std::shared_ptr<CRawMessage>& msg);
+        bool parse(std::shared_ptr<CRawMessage>& msg, const E_PARSE_BACKEND backend);
+
+        bool parse(std::shared_ptr<CRawMessage>& msg, const SchemaDocument_Type& schema);
+
+        bool parse_structural(const char* msg);
+
+        bool parse_lazy(std::shared_ptr<CRawMessage>& msg);
+
+        bool is_lazy(void) { return lazy_msg.get() != NULL; }
+
+        /** Parses member key of lazy object into cache. (manipulator) */
+        bool materialize(std::string &key);
+
+        /** Parses all members of lazy object, and leaves lazy mode. */
+        void materialize_all(void);
 
         bool has_member(std::string &key);
 
@@ -71,9 +205,15 @@ namespace json_mng
 
         void is_array_check(std::string &key);
 
+        /** Throws if this object is detached from the document of it's parent. */
+        void mutable_check(void);
+
         template <typename T=std::string>
         std::shared_ptr<std::list<std::shared_ptr<T>>> get_array(std::string &key);
 
+        template <typename T>
+        std::shared_ptr<std::list<std::shared_ptr<T>>> get_lazy_array(std::string &key);
+
         template <typename T>
         std::shared_ptr<T> get(ValueIterator itr);
 
@@ -89,15 +229,56 @@ namespace json_mng
 
         static std::string get_first_member(MemberIterator itor);
 
+        template <typename T>
+        static bool get_native(Value_Type& value, T& data);
+
+        /** Allocator for new values. Lazy object is parsed here. */
+        Allocator_Type& get_allocator(void);
+
+        void set_value(std::string &key, Value_Type &value);
+
+        void push_value(std::string &key, Value_Type &value);
+
+        /** Moves (or copies if allocator differs) members of value into target object. */
+        void take_object(CMjson& value, Value_Type& target);
+
+        /** Upper-bound of serialized length, for one-time allocation of output buffer. */
+        size_t estimate_dump_size(const E_DUMP format);
+
+        template <typename Writer>
+        bool write_object(Writer& writer);
+
     private:
         bool is_parsed;
 
         static const unsigned int read_bufsize = 1024;
 
+        static const size_t default_max_depth = 1024;
+
+        E_PARSE_MODE parse_mode;
+
+        size_t max_depth;
+
+        std::shared_ptr<Reader_Type> reader;
+
+        std::shared_ptr<CStructuralIndex> structural;
+
+        std::shared_ptr<CRawMessage> lazy_msg;     // text of lazy object. (NULL : not lazy)
+
+        size_t lazy_root;
+
+        bool detached;                  // lazy view (or view in it) : changes are not seen by the parent.
+
         char read_buf[read_bufsize];
 
         JsonManipulator manipulator;
 
+        Allocator_Type* allocator;      // allocator of document that owns object. (NULL : unknown)
+
+        Value_Type* root_value;         // value of object. (NULL : unknown)
+
+        Buffer_Type dump_buf;      // reused by dump().
+
         std::shared_ptr<Object_Type> object;
 
     };
@@ -0,0 +1,518 @@
+#include <cassert>
+#include <string.h>
+#include <algorithm>
+
+#include <logger.h>
+#include <json_patch.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+namespace {
+
+/** Objects up to this width are searched linearly by merge-patch. */
+const rapidjson::SizeType linear_members = 8;
+
+}
+
+/*******************************
+ * Public Function Definiction.
+ */
+CJsonPatch::CJsonPatch(void) {
+    ops.clear();
+    undo.clear();
+}
+
+CJsonPatch::~CJsonPatch(void) {
+    ops.clear();
+    undo.clear();
+}
+
+bool CJsonPatch::compile(const std::string& patch) {
+    ops.clear();
+    if ( patch_doc.Parse(patch.c_str()).HasParseError() || patch_doc.IsArray() == false ) {
+        LOGW("JSON Patch is not an array of operations.");
+        return false;
+    }
+    ops.reserve(patch_doc.Size());
+
+    for(Value_Type::ConstValueIterator itr = patch_doc.Begin(); itr != patch_doc.End(); itr++) {
+        Operation operation;
+        Value_Type::ConstMemberIterator op;
+        Value_Type::ConstMemberIterator path;
+        Value_Type::ConstMemberIterator member;
+
+        if ( itr->IsObject() == false ||
+             (op = itr->FindMember("op")) == itr->MemberEnd() || op->value.IsString() == false ||
+             parse_op(op->value.GetString(), operation.op) == false ||
+             (path = itr->FindMember("path")) == itr->MemberEnd() || path->value.IsString() == false ) {
+            LOGW("Invalid JSON Patch operation.(%zu)", ops.size());
+            ops.clear();
+            return false;
+        }
+        operation.path = Pointer_Type(path->value.GetString(), path->value.GetStringLength());
+        operation.value = NULL;
+
+        if ( operation.op == E_PATCH_OP::E_PATCH_OP_MOVE || operation.op == E_PATCH_OP::E_PATCH_OP_COPY ) {
+            if ( (member = itr->FindMember("from")) == itr->MemberEnd() || member->value.IsString() == false ) {
+                LOGW("JSON Patch operation has no 'from'.(%zu)", ops.size());
+                ops.clear();
+                return false;
+            }
+            operation.from = Pointer_Type(member->value.GetString(), member->value.GetStringLength());
+        }
+        else if ( operation.op != E_PATCH_OP::E_PATCH_OP_REMOVE ) {
+            if ( (member = itr->FindMember("value")) == itr->MemberEnd() ) {
+                LOGW("JSON Patch operation has no 'value'.(%zu)", ops.size());
+                ops.clear();
+                return false;
+            }
+            operation.value = &member->value;
+        }
+
+        if ( operation.path.IsValid() == false || operation.from.IsValid() == false ) {
+            LOGW("Invalid JSON-Pointer in JSON Patch.(%zu)", ops.size());
+            ops.clear();
+            return false;
+        }
+        ops.push_back(operation);
+    }
+    return true;
+}
+
+bool CJsonPatch::apply(Value_Type& root, Allocator_Type& allocator) {
+    undo.clear();
+
+    for(size_t i = 0; i < ops.size(); i++) {
+        if ( apply_operation(root, allocator, ops[i]) == false ) {
+            LOGW("JSON Patch operation failed, and rolled back.(%zu)", i);
+            rollback(root, allocator);
+            return false;
+        }
+    }
+    undo.clear();
+    return true;
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+bool CJsonPatch::parse_op(const char* name, E_PATCH_OP& op) {
+    static const char* names[] = { "add", "remove", "replace", "move", "copy", "test" };
+
+    for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if ( strcmp(name, names[i]) == 0 ) {
+            op = static_cast<E_PATCH_OP>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Value_Type* CJsonPatch::resolve(Value_Type& root, const Token* tokens, size_t count) {
+    Value_Type* value = &root;
+
+    for(size_t i = 0; i < count; i++) {
+        const Token& token = tokens[i];
+        if ( value->IsObject() == true ) {
+            MemberIterator member = value->FindMember(Value_Type(rapidjson::StringRef(token.name, token.length)));
+            if ( member == value->MemberEnd() ) {
+                return NULL;
+            }
+            value = &member->value;
+        }
+        else if ( value->IsArray() == true ) {
+            if ( token.index == rapidjson::kPointerInvalidIndex || token.index >= value->Size() ) {
+                return NULL;
+            }
+            value = &(*value)[token.index];
+        }
+        else {
+            return NULL;
+        }
+    }
+    return value;
+}
+
+bool CJsonPatch::is_prefix(const Pointer_Type& prefix, const Pointer_Type& path) {
+    if ( prefix.GetTokenCount() >= path.GetTokenCount() ) {
+        return false;
+    }
+    for(size_t i = 0; i < prefix.GetTokenCount(); i++) {
+        const Token& a = prefix.GetTokens()[i];
+        const Token& b = path.GetTokens()[i];
+        if ( a.length != b.length || memcmp(a.name, b.name, a.length) != 0 ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CJsonPatch::apply_operation(Value_Type& root, Allocator_Type& allocator, const Operation& operation) {
+    switch(operation.op) {
+    case E_PATCH_OP::E_PATCH_OP_ADD:
+        {
+            Value_Type value(*operation.value, allocator);
+            return add(root, allocator, operation.path, value);
+        }
+    case E_PATCH_OP::E_PATCH_OP_REMOVE:
+        {
+            Value_Type value;
+            return remove(root, operation.path, value, true);
+        }
+    case E_PATCH_OP::E_PATCH_OP_REPLACE:
+        {
+            Value_Type value(*operation.value, allocator);
+            return replace(root, operation.path, value);
+        }
+    case E_PATCH_OP::E_PATCH_OP_MOVE:
+        {
+            // a value can not be moved into it's own child.
+            Value_Type value;
+            if ( is_prefix(operation.from, operation.path) == true ||
+                 remove(root, operation.from, value, false) == false ) {
+                return false;
+            }
+            if ( add(root, allocator, operation.path, value) == false ) {
+                // value is not in document, so undo of 'remove' keeps it.
+                undo.back().carry = false;
+                undo.back().value = value;
+                return false;
+            }
+            return true;
+        }
+    case E_PATCH_OP::E_PATCH_OP_COPY:
+        {
+            const Value_Type* source = resolve(root, operation.from.GetTokens(), operation.from.GetTokenCount());
+            if ( source == NULL ) {
+                return false;
+            }
+            Value_Type value(*source, allocator);
+            return add(root, allocator, operation.path, value);
+        }
+    case E_PATCH_OP::E_PATCH_OP_TEST:
+        {
+            const Value_Type* target = resolve(root, operation.path.GetTokens(), operation.path.GetTokenCount());
+            return target != NULL && *target == *operation.value;
+        }
+    default:
+        return false;
+    }
+}
+
+bool CJsonPatch::add(Value_Type& root, Allocator_Type& allocator, const Pointer_Type& path, Value_Type& value) {
+    const Token* tokens = path.GetTokens();
+    const size_t count = path.GetTokenCount();
+
+    if ( count == 0 ) {
+        return replace(root, path, value);
+    }
+    Value_Type* parent = resolve(root, tokens, count - 1);
+    if ( parent == NULL ) {
+        return false;
+    }
+
+    const Token& last = tokens[count - 1];
+    E_UNDO kind = E_UNDO::E_UNDO_ERASE_MEMBER;
+    rapidjson::SizeType index = 0;
+    Value_Type old;
+    if ( parent->IsObject() == true ) {
+        MemberIterator member = parent->FindMember(Value_Type(rapidjson::StringRef(last.name, last.length)));
+        if ( member != parent->MemberEnd() ) {
+            kind = E_UNDO::E_UNDO_RESTORE_VALUE;
+            old = member->value;
+            member->value = value;
+        }
+        else {
+            index = parent->MemberCount();
+            Value_Type name(last.name, last.length, allocator);
+            parent->AddMember(name, value, allocator);
+        }
+    }
+    else if ( parent->IsArray() == true ) {
+        // '-' : after the last element.
+        index = (last.length == 1 && last.name[0] == '-') ? parent->Size() : last.index;
+        if ( index == rapidjson::kPointerInvalidIndex || index > parent->Size() ) {
+            return false;
+        }
+        kind = E_UNDO::E_UNDO_ERASE_ELEMENT;
+        parent->PushBack(value, allocator);
+        rotate_element(*parent, index);
+    }
+    else {
+        return false;
+    }
+
+    undo.emplace_back();
+    Undo& entry = undo.back();
+    entry.kind = kind;
+    entry.tokens = tokens;
+    entry.count = count;
+    entry.index = index;
+    entry.carry = false;
+    entry.value = old;
+    return true;
+}
+
+bool CJsonPatch::remove(Value_Type& root, const Pointer_Type& path, Value_Type& value, bool keep) {
+    const Token* tokens = path.GetTokens();
+    const size_t count = path.GetTokenCount();
+
+    if ( count == 0 ) {
+        return false;
+    }
+    Value_Type* parent = resolve(root, tokens, count - 1);
+    if ( parent == NULL ) {
+        return false;
+    }
+
+    const Token& last = tokens[count - 1];
+    E_UNDO kind = E_UNDO::E_UNDO_INSERT_MEMBER;
+    rapidjson::SizeType index = 0;
+    Value_Type name;
+    if ( parent->IsObject() == true ) {
+        MemberIterator member = parent->FindMember(Value_Type(rapidjson::StringRef(last.name, last.length)));
+        if ( member == parent->MemberEnd() ) {
+            return false;
+        }
+        index = static_cast<rapidjson::SizeType>(member - parent->MemberBegin());
+        name = member->name;
+        value = member->value;
+        parent->EraseMember(member);
+    }
+    else if ( parent->IsArray() == true ) {
+        index = last.index;
+        if ( index == rapidjson::kPointerInvalidIndex || index >= parent->Size() ) {
+            return false;
+        }
+        kind = E_UNDO::E_UNDO_INSERT_ELEMENT;
+        value = (*parent)[index];
+        parent->Erase(parent->Begin() + index);
+    }
+    else {
+        return false;
+    }
+
+    undo.emplace_back();
+    Undo& entry = undo.back();
+    entry.kind = kind;
+    entry.tokens = tokens;
+    entry.count = count;
+    entry.index = index;
+    entry.carry = (keep == false);
+    entry.name = name;
+    if ( keep == true ) {
+        entry.value = value;
+    }
+    return true;
+}
+
+bool CJsonPatch::replace(Value_Type& root, const Pointer_Type& path, Value_Type& value) {
+    Value_Type* target = resolve(root, path.GetTokens(), path.GetTokenCount());
+
+    // root of CMjson is always an object.
+    if ( target == NULL || (path.GetTokenCount() == 0 && value.IsObject() == false) ) {
+        return false;
+    }
+
+    undo.emplace_back();
+    Undo& entry = undo.back();
+    entry.kind = E_UNDO::E_UNDO_RESTORE_VALUE;
+    entry.tokens = path.GetTokens();
+    entry.count = path.GetTokenCount();
+    entry.index = 0;
+    entry.carry = false;
+    entry.value = *target;
+    *target = value;
+    return true;
+}
+
+void CJsonPatch::rollback(Value_Type& root, Allocator_Type& allocator) {
+    // value removed by 'move' is taken back from undo of it's 'add', which is just before.
+    Value_Type carry;
+
+    for(size_t i = undo.size(); i-- > 0;) {
+        Undo& entry = undo[i];
+        Value_Type* target = resolve(root, entry.tokens,
+                                     entry.kind == E_UNDO::E_UNDO_RESTORE_VALUE ? entry.count : entry.count - 1);
+        assert(target != NULL);
+
+        switch(entry.kind) {
+        case E_UNDO::E_UNDO_ERASE_MEMBER:
+            carry = (target->MemberBegin() + entry.index)->value;
+            target->EraseMember(target->MemberBegin() + entry.index);
+            break;
+        case E_UNDO::E_UNDO_ERASE_ELEMENT:
+            carry = (*target)[entry.index];
+            target->Erase(target->Begin() + entry.index);
+            break;
+        case E_UNDO::E_UNDO_RESTORE_VALUE:
+            carry = *target;
+            *target = entry.value;
+            break;
+        case E_UNDO::E_UNDO_INSERT_MEMBER:
+            target->AddMember(entry.name, entry.carry ? carry : entry.value, allocator);
+            rotate_member(*target, entry.index);
+            break;
+        case E_UNDO::E_UNDO_INSERT_ELEMENT:
+            target->PushBack(entry.carry ? carry : entry.value, allocator);
+            rotate_element(*target, entry.index);
+            break;
+        default:
+            break;
+        }
+    }
+    undo.clear();
+}
+
+void CJsonPatch::rotate_member(Value_Type& object, rapidjson::SizeType index) {
+    MemberIterator member = object.MemberEnd() - 1;
+
+    for(; member - object.MemberBegin() > static_cast<ptrdiff_t>(index); member--) {
+        member->name.Swap((member - 1)->name);
+        member->value.Swap((member - 1)->value);
+    }
+}
+
+void CJsonPatch::rotate_element(Value_Type& array, rapidjson::SizeType index) {
+    for(rapidjson::SizeType i = array.Size() - 1; i > index; i--) {
+        array[i].Swap(array[i - 1]);
+    }
+}
+
+/*******************************
+ * Public Function Definiction.
+ */
+void CJsonMergePatch::apply(Value_Type& target, Value_Type& patch, Allocator_Type& allocator, bool move) {
+    if ( patch.IsObject() == false ) {
+        take(target, patch, allocator, move);
+        return;
+    }
+    if ( target.IsObject() == false ) {
+        target.SetObject();
+    }
+    merge_object(target, patch, allocator, move);
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+void CJsonMergePatch::merge_object(Value_Type& target, Value_Type& patch, Allocator_Type& allocator, bool move) {
+    const rapidjson::SizeType count = target.MemberCount();
+    std::vector<NameIndex> names;
+    std::vector<bool> removed;
+
+    // wide target : members are looked up by sorted name-hash, instead of linear search.
+    if ( count > linear_members && patch.MemberCount() > 1 ) {
+        names.resize(count);
+        for(rapidjson::SizeType i = 0; i < count; i++) {
+            names[i].hash = hash_name((target.MemberBegin() + i)->name);
+            names[i].member = i;
+        }
+        std::sort(names.begin(), names.end());
+    }
+
+    for(MemberIterator itr = patch.MemberBegin(); itr != patch.MemberEnd(); itr++) {
+        const rapidjson::SizeType member = find_member(target, names, itr->name);
+
+        if ( itr->value.IsNull() == true ) {
+            // removed after all members are merged, so that indexes stay valid.
+            if ( member < target.MemberCount() ) {
+                removed.resize(target.MemberCount(), false);
+                removed[member] = true;
+            }
+            continue;
+        }
+
+        if ( member < target.MemberCount() ) {
+            if ( member < removed.size() ) {
+                removed[member] = false;
+            }
+            apply((target.MemberBegin() + member)->value, itr->value, allocator, move);
+        }
+        else {
+            Value_Type name;
+            Value_Type data;
+            take(name, itr->name, allocator, move);
+            apply(data, itr->value, allocator, move);
+            target.AddMember(name, data, allocator);
+        }
+    }
+
+    if ( removed.empty() == false ) {
+        compact(target, removed);
+    }
+}
+
+void CJsonMergePatch::take(Value_Type& target, Value_Type& value, Allocator_Type& allocator, bool move) {
+    if ( move == true ) {
+        target = value;
+    }
+    else {
+        target.CopyFrom(value, allocator);
+    }
+}
+
+uint64_t CJsonMergePatch::hash_name(const Value_Type& name) {
+    // FNV-1a
+    const char* str = name.GetString();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for(rapidjson::SizeType i = 0; i < name.GetStringLength(); i++) {
+        hash = (hash ^ static_cast<unsigned char>(str[i])) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+rapidjson::SizeType CJsonMergePatch::find_member(Value_Type& object, const std::vector<NameIndex>& names, const Value_Type& name) {
+    if ( names.empty() == false ) {
+        NameIndex key;
+        key.hash = hash_name(name);
+        key.member = 0;
+        std::vector<NameIndex>::const_iterator itr = std::lower_bound(names.begin(), names.end(), key);
+        for(; itr != names.end() && itr->hash == key.hash; itr++) {
+            if ( (object.MemberBegin() + itr->member)->name == name ) {
+                return itr->member;
+            }
+        }
+        // members added by this patch are not indexed.
+        for(rapidjson::SizeType i = static_cast<rapidjson::SizeType>(names.size()); i < object.MemberCount(); i++) {
+            if ( (object.MemberBegin() + i)->name == name ) {
+                return i;
+            }
+        }
+        return object.MemberCount();
+    }
+
+    for(rapidjson::SizeType i = 0; i < object.MemberCount(); i++) {
+        if ( (object.MemberBegin() + i)->name == name ) {
+            return i;
+        }
+    }
+    return object.MemberCount();
+}
+
+void CJsonMergePatch::compact(Value_Type& object, const std::vector<bool>& removed) {
+    rapidjson::SizeType kept = 0;
+
+    for(rapidjson::SizeType i = 0; i < object.MemberCount(); i++) {
+        if ( i < removed.size() && removed[i] == true ) {
+            continue;
+        }
+        if ( kept != i ) {
+            (object.MemberBegin() + kept)->name.Swap((object.MemberBegin() + i)->name);
+            (object.MemberBegin() + kept)->value.Swap((object.MemberBegin() + i)->value);
+        }
+        kept++;
+    }
+    while( object.MemberCount() > kept ) {
+        object.RemoveMember(object.MemberEnd() - 1);
+    }
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
@@ -0,0 +1,139 @@
+#ifndef _C_JSON_PATCH_H_
+#define _C_JSON_PATCH_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+
+namespace json_mng
+{
+    typedef enum E_PATCH_OP {
+        E_PATCH_OP_ADD = 0,
+        E_PATCH_OP_REMOVE = 1,
+        E_PATCH_OP_REPLACE = 2,
+        E_PATCH_OP_MOVE = 3,
+        E_PATCH_OP_COPY = 4,
+        E_PATCH_OP_TEST = 5,
+    } E_PATCH_OP;
+
+    /** RFC 6902 JSON Patch.
+     *  compile() parses the patch once into operations with tokenized JSON-Pointers,
+     *  and apply() runs them in place on a document. (values are moved, not copied)
+     *  apply() is atomic : if an operation fails, applied ones are undone in reverse order.
+     *  Undo-log keeps only moved-out values and positions, not a copy of the document.
+     */
+    class CJsonPatch {
+    public:
+        CJsonPatch(void);
+
+        ~CJsonPatch(void);
+
+        /** Compiles patch text. (array of operations) Returns false if it is not a valid patch. */
+        bool compile(const std::string& patch);
+
+        /** Number of compiled operations. */
+        size_t size(void) const { return ops.size(); }
+
+        /** Applies all operations to root with allocator of it's document.
+         *  Returns false and leaves root unchanged if an operation fails. (ex: path not found, test failed)
+         *  Root can be replaced only by an object. (path "")
+         */
+        bool apply(Value_Type& root, Allocator_Type& allocator);
+
+    private:
+        typedef Pointer_Type::Token Token;
+
+        typedef struct Operation {
+            E_PATCH_OP op;
+            Pointer_Type path;
+            Pointer_Type from;
+            const Value_Type* value;        // in patch_doc.
+        } Operation;
+
+        typedef enum E_UNDO {
+            E_UNDO_ERASE_MEMBER = 0,        // member was added.
+            E_UNDO_ERASE_ELEMENT = 1,       // element was inserted.
+            E_UNDO_RESTORE_VALUE = 2,       // value was replaced.
+            E_UNDO_INSERT_MEMBER = 3,       // member was removed.
+            E_UNDO_INSERT_ELEMENT = 4,      // element was removed.
+        } E_UNDO;
+
+        /** Paths are kept instead of pointers, because containers can be reallocated by later operations. */
+        typedef struct Undo {
+            E_UNDO kind;
+            const Token* tokens;            // target path. (in ops)
+            size_t count;
+            rapidjson::SizeType index;      // position of member or element in parent.
+            bool carry;                     // removed by 'move' : value is taken back from undo of it's 'add'.
+            Value_Type name;                // name of removed member.
+            Value_Type value;               // removed or replaced value.
+        } Undo;
+
+        static bool parse_op(const char* name, E_PATCH_OP& op);
+
+        static Value_Type* resolve(Value_Type& root, const Token* tokens, size_t count);
+
+        static bool is_prefix(const Pointer_Type& prefix, const Pointer_Type& path);
+
+        bool apply_operation(Value_Type& root, Allocator_Type& allocator, const Operation& operation);
+
+        /** Moves value into path. */
+        bool add(Value_Type& root, Allocator_Type& allocator, const Pointer_Type& path, Value_Type& value);
+
+        /** Moves value at path out to value. keep : value is kept in undo-log. */
+        bool remove(Value_Type& root, const Pointer_Type& path, Value_Type& value, bool keep);
+
+        bool replace(Value_Type& root, const Pointer_Type& path, Value_Type& value);
+
+        void rollback(Value_Type& root, Allocator_Type& allocator);
+
+        static void rotate_member(Value_Type& object, rapidjson::SizeType index);
+
+        static void rotate_element(Value_Type& array, rapidjson::SizeType index);
+
+    private:
+        JsonManipulator patch_doc;
+
+        std::vector<Operation> ops;
+
+        std::vector<Undo> undo;          // reused by apply().
+
+    };
+
+    /** RFC 7386 JSON Merge Patch.
+     *  Patch is merged into target in one pass over the patch. (null member removes the member)
+     *  With move, values are moved out of patch instead of copied : patch must be allocated
+     *  by allocator of target and be disjoint from it, (not target, nor inside or around it)
+     *  and is left with moved-out (null) values.
+     */
+    class CJsonMergePatch {
+    public:
+        static void apply(Value_Type& target, Value_Type& patch, Allocator_Type& allocator, bool move);
+
+    private:
+        /** Member index of object by name-hash, for wide objects. */
+        typedef struct NameIndex {
+            uint64_t hash;
+            rapidjson::SizeType member;
+            bool operator<(const NameIndex& other) const { return hash < other.hash; }
+        } NameIndex;
+
+        static void merge_object(Value_Type& target, Value_Type& patch, Allocator_Type& allocator, bool move);
+
+        static void take(Value_Type& target, Value_Type& value, Allocator_Type& allocator, bool move);
+
+        static uint64_t hash_name(const Value_Type& name);
+
+        /** Member index of name in object. (object.MemberCount() if not found) */
+        static rapidjson::SizeType find_member(Value_Type& object, const std::vector<NameIndex>& names, const Value_Type& name);
+
+        /** Removes marked members, keeping order of others. */
+        static void compact(Value_Type& object, const std::vector<bool>& removed);
+
+    };
+}
+
+#endif // _C_JSON_PATCH_H_
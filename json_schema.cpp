@@ -0,0 +1,140 @@
+#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <logger.h>
+#include <json_schema.h>
+#include <json_canonical.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+std::mutex CJsonSchema::cache_lock;
+
+std::map<std::string, std::shared_ptr<CJsonSchema>> CJsonSchema::cache;
+
+/*******************************
+ * Public Function Definiction.
+ */
+CJsonSchema::~CJsonSchema(void) {
+    compiled.reset();
+}
+
+std::shared_ptr<CJsonSchema> CJsonSchema::compile(const std::string& schema, const std::string& id) {
+    std::string key = id;
+
+    if ( key.empty() == true ) {
+        // content hash : not changed by white-space or member order.
+        CContentHash hasher;
+        Hash128 hash;
+        char hex[40];
+
+        if ( hasher.hash_message(schema.c_str(), hash) == false ) {
+            LOGW("Invalid schema.");
+            return std::shared_ptr<CJsonSchema>();
+        }
+        snprintf(hex, sizeof(hex), "#%016" PRIx64 "%016" PRIx64, hash.high, hash.low);
+        key = hex;
+    }
+
+    std::shared_ptr<CJsonSchema> ret = find(key);
+    if ( ret.get() != NULL ) {
+        return ret;
+    }
+    return insert(key, schema);
+}
+
+std::shared_ptr<CJsonSchema> CJsonSchema::load(const std::string& path, const std::string& id) {
+    std::string text;
+
+    if ( id.empty() == false ) {
+        std::shared_ptr<CJsonSchema> ret = find(id);
+        if ( ret.get() != NULL ) {
+            return ret;
+        }
+    }
+    if ( read_file(path, text) == false ) {
+        return std::shared_ptr<CJsonSchema>();
+    }
+    return compile(text, id);
+}
+
+void CJsonSchema::clear_cache(void) {
+    std::lock_guard<std::mutex> guard(cache_lock);
+    cache.clear();
+}
+
+size_t CJsonSchema::cache_size(void) {
+    std::lock_guard<std::mutex> guard(cache_lock);
+    return cache.size();
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+CJsonSchema::CJsonSchema(void) {
+    key.clear();
+    compiled.reset();
+}
+
+std::shared_ptr<CJsonSchema> CJsonSchema::find(const std::string& key) {
+    std::lock_guard<std::mutex> guard(cache_lock);
+    std::map<std::string, std::shared_ptr<CJsonSchema>>::iterator itr = cache.find(key);
+
+    if ( itr == cache.end() ) {
+        return std::shared_ptr<CJsonSchema>();
+    }
+    return itr->second;
+}
+
+std::shared_ptr<CJsonSchema> CJsonSchema::insert(const std::string& key, const std::string& schema) {
+    // compiled out of lock : racing threads may compile same schema, and first one is kept.
+    std::shared_ptr<CJsonSchema> ret(new CJsonSchema());
+
+    if ( ret->source.Parse(schema.c_str()).HasParseError() == true ) {
+        LOGW("Invalid schema.(%s)", key.c_str());
+        return std::shared_ptr<CJsonSchema>();
+    }
+    ret->key = key;
+    ret->compiled.reset(new SchemaDocument_Type(ret->source));
+
+    std::lock_guard<std::mutex> guard(cache_lock);
+    std::pair<std::map<std::string, std::shared_ptr<CJsonSchema>>::iterator, bool> inserted = cache.insert(std::make_pair(key, ret));
+    return inserted.first->second;
+}
+
+bool CJsonSchema::read_file(const std::string& path, std::string& text) {
+    char buf[4096];
+    ssize_t size = 0;
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if ( fd < 0 ) {
+        LOGERR("Can not open file.(%s)", path.c_str());
+        return false;
+    }
+
+    text.clear();
+    while( (size = read(fd, buf, sizeof(buf))) != 0 ) {
+        if ( size < 0 ) {
+            if ( errno == EINTR ) {
+                continue;
+            }
+            LOGERR("Can not read file.(%s)", path.c_str());
+            close(fd);
+            return false;
+        }
+        text.append(buf, static_cast<size_t>(size));
+    }
+    close(fd);
+    return true;
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
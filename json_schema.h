@@ -0,0 +1,67 @@
+#ifndef _C_JSON_SCHEMA_H_
+#define _C_JSON_SCHEMA_H_
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+#include <json_headers.h>
+
+namespace json_mng
+{
+    /** Compiled JSON Schema. (draft-04)
+     *  Schemas are compiled once and shared through a process-wide cache,
+     *  keyed by given id, or by content hash of schema text. (same schema in other formatting is a hit)
+     *  A compiled schema is read-only, and can be used by many threads at once.
+     */
+    class CJsonSchema {
+    public:
+        ~CJsonSchema(void);
+
+        /** Returns compiled schema of text from cache. NULL if text is not valid JSON.
+         *  id : cache-key. (empty : content hash of text) Text is not read on hit of id.
+         */
+        static std::shared_ptr<CJsonSchema> compile(const std::string& schema, const std::string& id="");
+
+        /** Returns compiled schema of file from cache. NULL if file can not be read or is not valid JSON. */
+        static std::shared_ptr<CJsonSchema> load(const std::string& path, const std::string& id="");
+
+        /** Drops cached schemas. Schemas in use are kept until they are released. */
+        static void clear_cache(void);
+
+        static size_t cache_size(void);
+
+        const std::string& get_key(void) const { return key; }
+
+        const SchemaDocument_Type& get_document(void) const { return *compiled; }
+
+        /** Schema text as JSON. */
+        const Value_Type& get_source(void) const { return source; }
+
+    private:
+        CJsonSchema(void);
+
+        static std::shared_ptr<CJsonSchema> find(const std::string& key);
+
+        /** Compiles text and puts it into cache. (existing entry of same key is returned) */
+        static std::shared_ptr<CJsonSchema> insert(const std::string& key, const std::string& schema);
+
+        static bool read_file(const std::string& path, std::string& text);
+
+    private:
+        static std::mutex cache_lock;
+
+        static std::map<std::string, std::shared_ptr<CJsonSchema>> cache;
+
+        std::string key;
+
+        JsonManipulator source;                         // schema document refers to this.
+
+        std::unique_ptr<SchemaDocument_Type> compiled;
+
+    };
+}
+
+#endif // _C_JSON_SCHEMA_H_
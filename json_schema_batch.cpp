@@ -0,0 +1,175 @@
+#include <cassert>
+#include <string.h>
+#include <algorithm>
+
+#include <logger.h>
+#include <json_schema_batch.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+namespace {
+
+/** Initial buffer of state allocator per worker : usual records are validated in it. */
+const size_t state_buffer_size = 64 * 1024;
+
+typedef rapidjson::MemoryPoolAllocator<> StateAllocator_Type;
+
+typedef rapidjson::GenericSchemaValidator<SchemaDocument_Type, rapidjson::BaseReaderHandler<rapidjson::UTF8<> >,
+                                          StateAllocator_Type> BatchValidator_Type;
+
+}
+
+/** Reusable state of a worker. */
+struct CSchemaBatch::Worker {
+    Worker(void) : buffer(state_buffer_size), allocator(buffer.data(), buffer.size()) {}
+
+    Reader_Type reader;
+
+    std::vector<char> buffer;
+
+    StateAllocator_Type allocator;      // validation states of one record. (cleared per record)
+};
+
+/*******************************
+ * Public Function Definiction.
+ */
+CSchemaBatch::CSchemaBatch(std::shared_ptr<CJsonSchema> schema, size_t threads)
+: schema(schema), records(NULL), results(NULL), next(0), generation(0), running(0), valid_count(0), stop(false) {
+    assert(schema.get() != NULL);
+
+    if ( threads == 0 ) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if ( threads == 0 ) {
+        threads = 1;
+    }
+
+    for(size_t i = 0; i < threads; i++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    for(size_t i = 1; i < threads; i++) {
+        this->threads.push_back(std::thread(&CSchemaBatch::run, this, i));
+    }
+}
+
+CSchemaBatch::~CSchemaBatch(void) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+
+    for(size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    threads.clear();
+    workers.clear();
+    schema.reset();
+}
+
+size_t CSchemaBatch::validate(const std::vector<std::string>& records, std::vector<SchemaResult>& results) {
+    results.resize(records.size());
+    if ( records.empty() == true ) {
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        this->records = &records;
+        this->results = &results;
+        next.store(0);
+        valid_count = 0;
+        running = threads.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    size_t valid = drain(*workers[0]);
+
+    std::unique_lock<std::mutex> guard(lock);
+    done.wait(guard, [this] { return running == 0; });
+    valid += valid_count;
+    this->records = NULL;
+    this->results = NULL;
+    return valid;
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+void CSchemaBatch::run(size_t index) {
+    size_t seen = 0;
+
+    while( true ) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this, seen] { return stop == true || generation != seen; });
+            if ( stop == true ) {
+                return;
+            }
+            seen = generation;
+        }
+
+        const size_t valid = drain(*workers[index]);
+
+        std::lock_guard<std::mutex> guard(lock);
+        valid_count += valid;
+        if ( --running == 0 ) {
+            done.notify_one();
+        }
+    }
+}
+
+size_t CSchemaBatch::drain(Worker& worker) {
+    const std::vector<std::string>& records = *this->records;
+    std::vector<SchemaResult>& results = *this->results;
+    const SchemaDocument_Type& document = schema->get_document();
+    size_t valid = 0;
+
+    for(size_t begin = next.fetch_add(chunk_size); begin < records.size(); begin = next.fetch_add(chunk_size)) {
+        const size_t end = std::min(begin + chunk_size, records.size());
+
+        for(size_t i = begin; i < end; i++) {
+            SchemaResult& result = results[i];
+            rapidjson::StringStream stream(records[i].c_str());
+
+            result.parsed = true;
+            result.offset = 0;
+            result.keyword.clear();
+            result.pointer.clear();
+            {
+                // validator is built in the cleared allocator per record : no state is carried over.
+                BatchValidator_Type validator(document, &worker.allocator);
+                // iterative : call-stack is not bounded by nesting of records.
+                rapidjson::ParseResult parsed = worker.reader.Parse<rapidjson::kParseDefaultFlags | rapidjson::kParseIterativeFlag>(stream, validator);
+
+                result.valid = !parsed.IsError();
+                if ( result.valid == true ) {
+                    valid++;
+                }
+                else if ( validator.IsValid() == false ) {
+                    Buffer_Type where;
+                    validator.GetInvalidDocumentPointer().StringifyUriFragment(where);
+                    if ( validator.GetInvalidSchemaKeyword() != NULL ) {
+                        result.keyword = validator.GetInvalidSchemaKeyword();
+                    }
+                    result.pointer.assign(where.GetString(), where.GetSize());
+                }
+                else {
+                    result.parsed = false;
+                    result.offset = parsed.Offset();
+                }
+            }
+            worker.allocator.Clear();
+        }
+    }
+    return valid;
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
@@ -0,0 +1,87 @@
+#ifndef _C_JSON_SCHEMA_BATCH_H_
+#define _C_JSON_SCHEMA_BATCH_H_
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+#include <json_headers.h>
+#include <json_schema.h>
+
+namespace json_mng
+{
+    /** Result of validation of one record. */
+    typedef struct SchemaResult {
+        bool valid;
+        bool parsed;                // false : record is not valid JSON. (offset is set)
+        size_t offset;              // offset of parse-error in record.
+        std::string keyword;        // violated keyword of schema. (ex: "required")
+        std::string pointer;        // JSON-Pointer of violating value in record. (URI fragment)
+    } SchemaResult;
+
+    /** Validates batches of records against one compiled schema on a pool of threads.
+     *  All workers share the read-only compiled schema. Each worker keeps its own
+     *  Reader and state allocator over batches, so records are validated without DOM
+     *  and mostly without heap allocation.
+     *  validate() is not re-entrant : one batch at a time per object.
+     */
+    class CSchemaBatch {
+    public:
+        /** threads : number of workers including the calling thread. (0 : all cores) */
+        CSchemaBatch(std::shared_ptr<CJsonSchema> schema, size_t threads=0);
+
+        ~CSchemaBatch(void);
+
+        /** Validates each record. results[i] is set for records[i]. Returns count of valid records. */
+        size_t validate(const std::vector<std::string>& records, std::vector<SchemaResult>& results);
+
+        size_t get_threads(void) const { return workers.size(); }
+
+    private:
+        struct Worker;
+
+        /** Records taken at once by a worker. */
+        static const size_t chunk_size = 64;
+
+        void run(size_t index);
+
+        /** Takes chunks of current batch until none is left. Returns count of valid records. */
+        size_t drain(Worker& worker);
+
+    private:
+        std::shared_ptr<CJsonSchema> schema;
+
+        std::vector<std::unique_ptr<Worker>> workers;      // workers[0] is run by caller of validate().
+
+        std::vector<std::thread> threads;
+
+        std::mutex lock;
+
+        std::condition_variable wake;
+
+        std::condition_variable done;
+
+        // current batch. (guarded by lock, except next)
+        const std::vector<std::string>* records;
+
+        std::vector<SchemaResult>* results;
+
+        std::atomic<size_t> next;
+
+        size_t generation;
+
+        size_t running;
+
+        size_t valid_count;
+
+        bool stop;
+
+    };
+}
+
+#endif // _C_JSON_SCHEMA_BATCH_H_
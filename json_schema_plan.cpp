@@ -0,0 +1,205 @@
+#include <cassert>
+#include <string.h>
+#include <algorithm>
+
+#include <logger.h>
+#include <json_schema_plan.h>
+
+namespace json_mng
+{
+
+#ifdef JSON_LIB_RAPIDJSON
+/*******************************
+ * Public Function Definiction.
+ */
+CSchemaPlan::CSchemaPlan(std::shared_ptr<CJsonSchema> schema) : schema(schema) {
+    assert(schema.get() != NULL);
+    std::vector<const Value_Type*> expanding;
+
+    fields.clear();
+    add_properties(schema->get_source(), root, "", true, 0, expanding);
+}
+
+CSchemaPlan::~CSchemaPlan(void) {
+    fields.clear();
+    schema.reset();
+}
+
+size_t CSchemaPlan::find(const std::string& path) const {
+    for(size_t i = 0; i < fields.size(); i++) {
+        if ( fields[i].path == path ) {
+            return i;
+        }
+    }
+    return fields.size();
+}
+
+CPlanReader::CPlanReader(const CSchemaPlan& plan)
+: plan(plan), slots(plan.size(), NULL), hints(plan.size(), 0) {
+}
+
+CPlanReader::~CPlanReader(void) {
+    slots.clear();
+    hints.clear();
+}
+
+void CPlanReader::bind(const Value_Type& root) {
+    for(size_t i = 0; i < plan.fields.size(); i++) {
+        const CSchemaPlan::Field& field = plan.fields[i];
+        const Value_Type* parent = (field.parent == CSchemaPlan::root) ? &root : slots[field.parent];
+
+        slots[i] = NULL;
+        if ( parent == NULL || parent->IsObject() == false ) {
+            continue;
+        }
+
+        // position in previous document first.
+        const rapidjson::SizeType count = parent->MemberCount();
+        const Value_Type::ConstMemberIterator members = parent->MemberBegin();
+        const rapidjson::SizeType hint = hints[i];
+        if ( hint < count &&
+             members[hint].name.GetStringLength() == field.name.length() &&
+             memcmp(members[hint].name.GetString(), field.name.data(), field.name.length()) == 0 ) {
+            slots[i] = &members[hint].value;
+            continue;
+        }
+        for(rapidjson::SizeType j = 0; j < count; j++) {
+            if ( members[j].name.GetStringLength() == field.name.length() &&
+                 memcmp(members[j].name.GetString(), field.name.data(), field.name.length()) == 0 ) {
+                slots[i] = &members[j].value;
+                hints[i] = j;
+                break;
+            }
+        }
+    }
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+void CSchemaPlan::add_properties(const Value_Type& schema, size_t parent, const std::string& path, bool required, size_t depth,
+                                 std::vector<const Value_Type*>& expanding) {
+    const Value_Type* object = resolve(schema, 0);
+
+    if ( object == NULL || object->IsObject() == false ) {
+        return;
+    }
+    Value_Type::ConstMemberIterator properties = object->FindMember("properties");
+    if ( properties == object->MemberEnd() || properties->value.IsObject() == false ) {
+        return;
+    }
+    expanding.push_back(object);
+    Value_Type::ConstMemberIterator names = object->FindMember("required");
+
+    for(Value_Type::ConstMemberIterator itr = properties->value.MemberBegin(); itr != properties->value.MemberEnd(); itr++) {
+        const Value_Type* property = resolve(itr->value, 0);
+        Field field;
+
+        field.name.assign(itr->name.GetString(), itr->name.GetStringLength());
+        field.path = path;
+        escape(itr->name, field.path);
+        field.parent = parent;
+        field.type = (property == NULL) ? E_FIELD_TYPE::E_FIELD_TYPE_ANY : parse_type(*property);
+        field.required = false;
+        if ( required == true && names != object->MemberEnd() && names->value.IsArray() == true ) {
+            for(Value_Type::ConstValueIterator name = names->value.Begin(); name != names->value.End(); name++) {
+                if ( name->IsString() == true && *name == itr->name ) {
+                    field.required = true;
+                    break;
+                }
+            }
+        }
+
+        // field is copied : fields can be reallocated by members of it.
+        fields.push_back(field);
+        // recursive "$ref" : schema being expanded on this path is left without members.
+        if ( property != NULL && depth < max_depth &&
+             std::find(expanding.begin(), expanding.end(), property) == expanding.end() ) {
+            add_properties(*property, fields.size() - 1, field.path, field.required, depth + 1, expanding);
+        }
+    }
+    expanding.pop_back();
+}
+
+const Value_Type* CSchemaPlan::resolve(const Value_Type& schema, size_t depth) const {
+    if ( schema.IsObject() == false ) {
+        return &schema;
+    }
+    Value_Type::ConstMemberIterator ref = schema.FindMember("$ref");
+    if ( ref == schema.MemberEnd() || ref->value.IsString() == false ) {
+        return &schema;
+    }
+    // only reference in this document. (ex: "#/definitions/item")
+    if ( ref->value.GetStringLength() == 0 || ref->value.GetString()[0] != '#' || depth >= max_depth ) {
+        return NULL;
+    }
+
+    Pointer_Type pointer(ref->value.GetString(), ref->value.GetStringLength());
+    const Value_Type* target = pointer.IsValid() ? pointer.Get(this->schema->get_source()) : NULL;
+    if ( target == NULL ) {
+        LOGW("Can not resolve reference.(%s)", ref->value.GetString());
+        return NULL;
+    }
+    return resolve(*target, depth + 1);
+}
+
+E_FIELD_TYPE CSchemaPlan::parse_type(const Value_Type& schema) {
+    if ( schema.IsObject() == false ) {
+        return E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+    }
+    Value_Type::ConstMemberIterator type = schema.FindMember("type");
+    if ( type == schema.MemberEnd() ) {
+        return E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+    }
+
+    const Value_Type* name = &type->value;
+    if ( name->IsArray() == true && name->Size() == 1 ) {
+        name = &(*name)[0];
+    }
+    if ( name->IsString() == false ) {
+        return E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+    }
+
+    static const struct {
+        const char* name;
+        E_FIELD_TYPE type;
+    } types[] = {
+        { "null", E_FIELD_TYPE::E_FIELD_TYPE_NULL },
+        { "boolean", E_FIELD_TYPE::E_FIELD_TYPE_BOOL },
+        { "integer", E_FIELD_TYPE::E_FIELD_TYPE_INTEGER },
+        { "number", E_FIELD_TYPE::E_FIELD_TYPE_NUMBER },
+        { "string", E_FIELD_TYPE::E_FIELD_TYPE_STRING },
+        { "object", E_FIELD_TYPE::E_FIELD_TYPE_OBJECT },
+        { "array", E_FIELD_TYPE::E_FIELD_TYPE_ARRAY },
+    };
+    for(size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if ( strcmp(name->GetString(), types[i].name) == 0 ) {
+            return types[i].type;
+        }
+    }
+    return E_FIELD_TYPE::E_FIELD_TYPE_ANY;
+}
+
+void CSchemaPlan::escape(const Value_Type& name, std::string& path) {
+    const char* str = name.GetString();
+
+    path.push_back('/');
+    for(rapidjson::SizeType i = 0; i < name.GetStringLength(); i++) {
+        // '~' -> "~0", '/' -> "~1"
+        if ( str[i] == '~' ) {
+            path.append("~0", 2);
+        }
+        else if ( str[i] == '/' ) {
+            path.append("~1", 2);
+        }
+        else {
+            path.push_back(str[i]);
+        }
+    }
+}
+
+#elif JSON_LIB_HLOHMANN
+    // TODO
+#endif // JSON_LIB_RAPIDJSON or JSON_LIB_HLOHMANN
+
+}
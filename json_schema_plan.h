@@ -0,0 +1,127 @@
+#ifndef _C_JSON_SCHEMA_PLAN_H_
+#define _C_JSON_SCHEMA_PLAN_H_
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+#include <json_schema.h>
+
+namespace json_mng
+{
+    typedef enum E_FIELD_TYPE {
+        E_FIELD_TYPE_ANY = 0,       // type is not fixed by schema. (get_value() only)
+        E_FIELD_TYPE_NULL = 1,
+        E_FIELD_TYPE_BOOL = 2,
+        E_FIELD_TYPE_INTEGER = 3,
+        E_FIELD_TYPE_NUMBER = 4,
+        E_FIELD_TYPE_STRING = 5,
+        E_FIELD_TYPE_OBJECT = 6,
+        E_FIELD_TYPE_ARRAY = 7,
+    } E_FIELD_TYPE;
+
+    /** Access plan of fields known by schema.
+     *  "properties" of object schemas are flattened into fields with JSON-Pointer paths, (ex: "/a/b")
+     *  each with the type fixed by "type" keyword, and whether it always exists. ("required" up to root)
+     *  Local "$ref" is followed. Fields are kept in pre-order : parent before it's members.
+     */
+    class CSchemaPlan {
+    public:
+        CSchemaPlan(std::shared_ptr<CJsonSchema> schema);
+
+        ~CSchemaPlan(void);
+
+        size_t size(void) const { return fields.size(); }
+
+        /** Field of JSON-Pointer path. size() if path is not in plan. */
+        size_t find(const std::string& path) const;
+
+        const std::string& get_path(size_t field) const { return fields[field].path; }
+
+        E_FIELD_TYPE get_type(size_t field) const { return fields[field].type; }
+
+        /** Field exists in every document valid for schema. */
+        bool is_required(size_t field) const { return fields[field].required; }
+
+        /** Type fixed by "type" keyword of schema. (E_FIELD_TYPE_ANY if not one type) */
+        static E_FIELD_TYPE parse_type(const Value_Type& schema);
+
+    private:
+        friend class CPlanReader;
+
+        static const size_t root = SIZE_MAX;
+
+        static const size_t max_depth = 32;
+
+        typedef struct Field {
+            std::string path;
+            std::string name;
+            size_t parent;          // root : object given to bind().
+            E_FIELD_TYPE type;
+            bool required;
+        } Field;
+
+        /** expanding : object schemas on path from root, to stop at recursive "$ref". */
+        void add_properties(const Value_Type& schema, size_t parent, const std::string& path, bool required, size_t depth,
+                            std::vector<const Value_Type*>& expanding);
+
+        /** Follows local "$ref". (NULL if not found) */
+        const Value_Type* resolve(const Value_Type& schema, size_t depth) const;
+
+        static void escape(const Value_Type& name, std::string& path);
+
+    private:
+        std::shared_ptr<CJsonSchema> schema;       // source of schema is referred.
+
+        std::vector<Field> fields;
+
+    };
+
+    /** Reads fields of a document validated by schema of plan, without type-checks.
+     *  bind() resolves all fields in one pass, trying the member positions of the previous
+     *  document first. (documents of same producer have same member order)
+     *  Accessors do not check type : reading a field of other type is undefined.
+     */
+    class CPlanReader {
+    public:
+        CPlanReader(const CSchemaPlan& plan);
+
+        ~CPlanReader(void);
+
+        /** Resolves fields in root. (root must be valid for schema of plan) */
+        void bind(const Value_Type& root);
+
+        /** Field exists in bound document. (always true for required fields) */
+        bool has(size_t field) const { return slots[field] != NULL; }
+
+        bool get_bool(size_t field) const { return slots[field]->IsTrue(); }
+
+        /** E_FIELD_TYPE_INTEGER. (within int64) */
+        int64_t get_int64(size_t field) const { return slots[field]->GetInt64(); }
+
+        int get_int(size_t field) const { return static_cast<int>(slots[field]->GetInt64()); }
+
+        /** E_FIELD_TYPE_NUMBER or E_FIELD_TYPE_INTEGER. */
+        double get_double(size_t field) const { return slots[field]->GetDouble(); }
+
+        /** E_FIELD_TYPE_STRING. Valid while bound document is not changed. */
+        const char* get_string(size_t field) const { return slots[field]->GetString(); }
+
+        size_t get_string_length(size_t field) const { return slots[field]->GetStringLength(); }
+
+        const Value_Type& get_value(size_t field) const { return *slots[field]; }
+
+    private:
+        const CSchemaPlan& plan;
+
+        std::vector<const Value_Type*> slots;
+
+        std::vector<rapidjson::SizeType> hints;     // member position of each field in previous document.
+
+    };
+}
+
+#endif // _C_JSON_SCHEMA_PLAN_H_
@@ -0,0 +1,654 @@
+#include <cassert>
+#include <string.h>
+#include <limits>
+
+#include <logger.h>
+#include <json_structural_index.h>
+
+#ifdef JSON_LIB_RAPIDJSON
+#include <rapidjson/internal/strtod.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define STAGE1_X86
+#endif
+
+namespace json_mng
+{
+
+/*******************************
+ * Stage 1 : Structural index.
+ */
+namespace {
+
+const uint64_t even_bits = 0x5555555555555555ULL;
+const uint64_t odd_bits = ~even_bits;
+
+/** Character-class bitmasks of one 64-byte block. */
+typedef struct CBlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;            // { } [ ] : ,
+    uint64_t whitespace;
+} CBlockMasks;
+
+/** Carried state between blocks. */
+typedef struct CStage1State {
+    uint64_t prev_odd_backslash;    // 1 : first character of block is escaped.
+    uint64_t prev_in_string;        // all-ones : block starts inside string.
+    uint64_t prev_delimiter;        // 1 : last character of previous block is op/whitespace/quote.
+} CStage1State;
+
+/** Characters escaped by an odd-length run of backslashes. */
+inline uint64_t find_escaped(uint64_t backslash, uint64_t& prev_odd_backslash) {
+    // an escaped backslash does not start new escape-sequence.
+    uint64_t bs = backslash & ~prev_odd_backslash;
+    uint64_t starts = bs & ~(bs << 1);
+    uint64_t even_carries = bs + (starts & even_bits);
+    uint64_t odd_carries = bs + (starts & odd_bits);
+    uint64_t escaped = (even_carries & ~bs & odd_bits) | (odd_carries & ~bs & even_bits);
+
+    escaped |= prev_odd_backslash;
+    // odd-started run reaching the last bit has odd length.
+    prev_odd_backslash = (odd_carries < bs) ? 1 : 0;
+    return escaped;
+}
+
+/** Structural bits of one block, from masks and inclusive in-string region. */
+inline uint64_t find_structurals(const CBlockMasks& m, uint64_t quote, uint64_t in_string, CStage1State& state) {
+    uint64_t delimiter = m.op | m.whitespace | quote;
+    uint64_t after_delimiter = (delimiter << 1) | state.prev_delimiter;
+    uint64_t scalar_starts = after_delimiter & ~delimiter & ~in_string;
+
+    state.prev_delimiter = delimiter >> 63;
+    return (m.op & ~in_string) | (quote & in_string) | scalar_starts;
+}
+
+inline uint32_t* flatten(uint64_t bits, uint32_t base, uint32_t* out) {
+    while (bits != 0) {
+        *out++ = base + static_cast<uint32_t>(__builtin_ctzll(bits));
+        bits &= bits - 1;
+    }
+    return out;
+}
+
+inline uint64_t prefix_xor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+inline void classify(const char* block, CBlockMasks& m) {
+    m.quote = m.backslash = m.op = m.whitespace = 0;
+    for (unsigned i = 0; i < 64; i++) {
+        const uint64_t bit = 1ULL << i;
+        switch (block[i]) {
+        case '"':  m.quote |= bit; break;
+        case '\\': m.backslash |= bit; break;
+        case '{': case '}': case '[': case ']': case ':': case ',':
+            m.op |= bit; break;
+        case ' ': case '\t': case '\n': case '\r':
+            m.whitespace |= bit; break;
+        default:
+            break;
+        }
+    }
+}
+
+uint32_t* stage1_scalar(const char* json, size_t blocks, CStage1State& state, uint32_t* out) {
+    CBlockMasks m;
+    for (size_t b = 0; b < blocks; b++) {
+        classify(json + b * 64, m);
+        uint64_t quote = m.quote & ~find_escaped(m.backslash, state.prev_odd_backslash);
+        uint64_t in_string = prefix_xor(quote) ^ state.prev_in_string;
+        state.prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+        out = flatten(find_structurals(m, quote, in_string, state), static_cast<uint32_t>(b * 64), out);
+    }
+    return out;
+}
+
+#ifdef STAGE1_X86
+__attribute__((target("avx2")))
+inline uint64_t eq_mask(__m256i lo, __m256i hi, char c) {
+    const __m256i v = _mm256_set1_epi8(c);
+    uint64_t l = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, v)));
+    uint64_t h = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, v)));
+    return l | (h << 32);
+}
+
+__attribute__((target("avx2")))
+inline void classify_avx2(const char* block, CBlockMasks& m) {
+    const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+    m.quote = eq_mask(lo, hi, '"');
+    m.backslash = eq_mask(lo, hi, '\\');
+    m.op = eq_mask(lo, hi, '{') | eq_mask(lo, hi, '}') | eq_mask(lo, hi, '[')
+         | eq_mask(lo, hi, ']') | eq_mask(lo, hi, ':') | eq_mask(lo, hi, ',');
+    m.whitespace = eq_mask(lo, hi, ' ') | eq_mask(lo, hi, '\t') | eq_mask(lo, hi, '\n') | eq_mask(lo, hi, '\r');
+}
+
+__attribute__((target("pclmul")))
+inline uint64_t prefix_xor_clmul(uint64_t bits) {
+    // carry-less multiplication by all-ones computes prefix-xor.
+    const __m128i all_ones = _mm_set1_epi8(static_cast<char>(0xFF));
+    const __m128i r = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<int64_t>(bits)), all_ones, 0);
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(r));
+}
+
+__attribute__((target("avx2,pclmul")))
+uint32_t* stage1_avx2(const char* json, size_t blocks, CStage1State& state, uint32_t* out) {
+    CBlockMasks m;
+    for (size_t b = 0; b < blocks; b++) {
+        classify_avx2(json + b * 64, m);
+        uint64_t quote = m.quote & ~find_escaped(m.backslash, state.prev_odd_backslash);
+        uint64_t in_string = prefix_xor_clmul(quote) ^ state.prev_in_string;
+        state.prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+        out = flatten(find_structurals(m, quote, in_string, state), static_cast<uint32_t>(b * 64), out);
+    }
+    return out;
+}
+
+bool has_avx2(void) {
+    static const bool supported = (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul"));
+    return supported;
+}
+#endif // STAGE1_X86
+
+}   // namespace
+
+/*******************************
+ * Public Function Definiction.
+ */
+CStructuralIndex::CStructuralIndex(void) : json(NULL), length(0), count(0) {
+    index.clear();
+}
+
+CStructuralIndex::~CStructuralIndex(void) {
+    json = NULL;
+    length = 0;
+    count = 0;
+    index.clear();
+}
+
+bool CStructuralIndex::build(const char* json, size_t length) {
+    assert(json != NULL);
+    assert(json[length] == '\0');
+    assert(length < std::numeric_limits<uint32_t>::max());
+    const size_t full_blocks = length / 64;
+    const uint32_t tail_base = static_cast<uint32_t>(full_blocks * 64);
+    char tail[64];
+    uint32_t* out = NULL;
+    CStage1State state = { 0, 0, 1 };    // start of text is delimiter.
+    uint32_t* (*stage1)(const char*, size_t, CStage1State&, uint32_t*) = stage1_scalar;
+
+#ifdef STAGE1_X86
+    if ( has_avx2() == true ) {
+        stage1 = stage1_avx2;
+    }
+#endif
+
+    this->json = json;
+    this->length = length;
+    // every character can be structural. buffer is grown only, and reused by next build.
+    if ( index.size() < length + 64 ) {
+        index.resize(length + 64);
+    }
+    out = stage1(json, full_blocks, state, &index[0]);
+
+    // last partial block is padded with whitespace.
+    memset(tail, ' ', sizeof(tail));
+    memcpy(tail, json + tail_base, length - tail_base);
+    uint32_t* tail_begin = out;
+    out = stage1(tail, 1, state, out);
+    for (uint32_t* i = tail_begin; i != out; i++) {
+        *i += tail_base;
+    }
+    count = static_cast<size_t>(out - &index[0]);
+
+    // string must be closed.
+    return state.prev_in_string == 0;
+}
+
+bool CStructuralIndex::match_brackets(void) {
+    std::vector<uint32_t> opens;
+
+    if ( match.size() < count ) {
+        match.resize(count);
+    }
+    for (size_t pos = 0; pos < count; pos++) {
+        const char c = char_at(pos);
+
+        if ( c == '{' || c == '[' ) {
+            opens.push_back(static_cast<uint32_t>(pos));
+        }
+        else if ( c == '}' || c == ']' ) {
+            if ( opens.empty() == true || (c == '}') != (char_at(opens.back()) == '{') ) {
+                return false;
+            }
+            match[opens.back()] = static_cast<uint32_t>(pos);
+            opens.pop_back();
+        }
+    }
+    return opens.empty();
+}
+
+/***
+ * Third-party library dependency function.
+ */
+#ifdef JSON_LIB_RAPIDJSON
+bool CStructuralIndex::populate(JsonManipulator& doc, size_t max_depth) {
+    size_t pos = 0;
+
+    stack.clear();
+    if ( count == 0 ) {
+        return false;
+    }
+    if ( populate_value(doc, pos, max_depth) == false ) {
+        return false;
+    }
+    // Only one root is allowed.
+    return pos == count;
+}
+
+bool CStructuralIndex::populate_value(JsonManipulator& doc, size_t& pos, size_t max_depth) {
+    const size_t bottom = stack.size();
+
+    if ( walk(doc, pos, max_depth, bottom) == false ) {
+        stack.resize(bottom);
+        return false;
+    }
+    return true;
+}
+
+bool CStructuralIndex::find_member(size_t object_pos, const char* key, size_t key_length, size_t& value_pos) {
+    assert(char_at(object_pos) == '{');
+    const size_t end = match[object_pos];
+    size_t pos = object_pos + 1;
+
+    while( pos < end ) {
+        const char* p = json + index[pos];
+        const char* str = NULL;
+        size_t str_length = 0;
+
+        if ( *p != '"' || char_at(pos + 1) != ':' ) {
+            return false;
+        }
+        // Fast-path : key without escape is compared in the text.
+        if ( strncmp(p + 1, key, key_length) == 0 && p[1 + key_length] == '"' &&
+             memchr(p + 1, '\\', key_length) == NULL ) {
+            value_pos = pos + 2;
+            return true;
+        }
+        if ( memchr(p + 1, '\\', strcspn(p + 1, "\"")) != NULL ) {
+            if ( read_string(p + 1, str, str_length) == false ) {
+                return false;
+            }
+            if ( str_length == key_length && memcmp(str, key, key_length) == 0 ) {
+                value_pos = pos + 2;
+                return true;
+            }
+        }
+
+        pos = skip(pos + 2);
+        if ( pos >= end || char_at(pos) != ',' ) {
+            return false;
+        }
+        pos++;
+    }
+    return false;
+}
+
+/*******************************
+ * Private Function Definiction.
+ */
+bool CStructuralIndex::walk(JsonManipulator& doc, size_t& pos, size_t max_depth, size_t bottom) {
+    enum { VALUE, KEY, AFTER_VALUE } state = VALUE;
+    const size_t n = count;
+
+    while( pos < n ) {
+        const char* p = json + index[pos];
+
+        switch(state) {
+        case VALUE:
+            pos++;
+            if ( *p == '{' || *p == '[' ) {
+                const bool is_object = (*p == '{');
+                const char close = is_object ? '}' : ']';
+
+                if ( max_depth != 0 && stack.size() - bottom >= max_depth ) {
+                    LOGW("Nesting-depth exceeds limit.(%zu)", max_depth);
+                    return false;
+                }
+                if ( is_object ? !doc.StartObject() : !doc.StartArray() ) {
+                    return false;
+                }
+                if ( pos < n && json[index[pos]] == close ) {
+                    pos++;
+                    if ( is_object ? !doc.EndObject(0) : !doc.EndArray(0) ) {
+                        return false;
+                    }
+                    state = AFTER_VALUE;
+                    break;
+                }
+                Frame frame = { is_object, 0 };
+                stack.push_back(frame);
+                state = is_object ? KEY : VALUE;
+                break;
+            }
+            if ( *p == '"' ) {
+                if ( parse_string(doc, p + 1, false) == false ) {
+                    return false;
+                }
+            }
+            else if ( parse_atom(doc, p) == false ) {
+                return false;
+            }
+            state = AFTER_VALUE;
+            break;
+        case KEY:
+            if ( *p != '"' || parse_string(doc, p + 1, true) == false ) {
+                return false;
+            }
+            if ( pos + 1 >= n || json[index[pos + 1]] != ':' ) {
+                return false;
+            }
+            pos += 2;
+            state = VALUE;
+            break;
+        case AFTER_VALUE:
+            {
+                if ( stack.size() == bottom ) {
+                    return true;
+                }
+                Frame& top = stack.back();
+                top.count++;
+                pos++;
+                if ( *p == ',' ) {
+                    state = top.is_object ? KEY : VALUE;
+                }
+                else if ( *p == (top.is_object ? '}' : ']') ) {
+                    bool ok = top.is_object ? doc.EndObject(top.count) : doc.EndArray(top.count);
+                    stack.pop_back();
+                    if ( ok == false ) {
+                        return false;
+                    }
+                }
+                else {
+                    return false;
+                }
+            }
+            break;
+        }
+    }
+
+    return state == AFTER_VALUE && stack.size() == bottom;
+}
+
+inline bool CStructuralIndex::is_delimiter(char c) {
+    switch(c) {
+    case ',': case '}': case ']': case ':':
+    case ' ': case '\t': case '\n': case '\r': case '\0':
+        return true;
+    default:
+        return false;
+    }
+}
+
+static inline int hex_digit(char c) {
+    if ( c >= '0' && c <= '9' ) return c - '0';
+    if ( c >= 'a' && c <= 'f' ) return c - 'a' + 10;
+    if ( c >= 'A' && c <= 'F' ) return c - 'A' + 10;
+    return -1;
+}
+
+static bool parse_hex4(const char* p, unsigned& codepoint) {
+    codepoint = 0;
+    for (int i = 0; i < 4; i++) {
+        int h = hex_digit(p[i]);
+        if ( h < 0 ) {
+            return false;
+        }
+        codepoint = (codepoint << 4) | static_cast<unsigned>(h);
+    }
+    return true;
+}
+
+static void encode_utf8(std::string& out, unsigned codepoint) {
+    if ( codepoint <= 0x7F ) {
+        out += static_cast<char>(codepoint);
+    }
+    else if ( codepoint <= 0x7FF ) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else if ( codepoint <= 0xFFFF ) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+    else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+static inline const char* scan_unescaped(const char* p) {
+#ifdef RAPIDJSON_SIMD_DISPATCH
+    return rapidjson::internal::GetSimdKernels().scanUnescaped(p);
+#else
+    while ( *p != '"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20 ) {
+        p++;
+    }
+    return p;
+#endif
+}
+
+bool CStructuralIndex::read_string(const char* p, const char*& str, size_t& str_length) {
+    const char* q = scan_unescaped(p);
+
+    // Fast-path : string without escape.
+    if ( *q == '"' ) {
+        str = p;
+        str_length = static_cast<size_t>(q - p);
+        return true;
+    }
+
+    scratch.assign(p, q - p);
+    for ( p = q; *p != '"'; p = q ) {
+        if ( *p != '\\' ) {
+            return false;   // control-character or end of text.
+        }
+        switch( p[1] ) {
+        case '"':  scratch += '"'; break;
+        case '\\': scratch += '\\'; break;
+        case '/':  scratch += '/'; break;
+        case 'b':  scratch += '\b'; break;
+        case 'f':  scratch += '\f'; break;
+        case 'n':  scratch += '\n'; break;
+        case 'r':  scratch += '\r'; break;
+        case 't':  scratch += '\t'; break;
+        case 'u':
+            {
+                unsigned codepoint = 0;
+                if ( parse_hex4(p + 2, codepoint) == false ) {
+                    return false;
+                }
+                if ( codepoint >= 0xD800 && codepoint <= 0xDBFF ) {
+                    // UTF-16 surrogate pair
+                    unsigned codepoint2 = 0;
+                    if ( p[6] != '\\' || p[7] != 'u' || parse_hex4(p + 8, codepoint2) == false ) {
+                        return false;
+                    }
+                    if ( codepoint2 < 0xDC00 || codepoint2 > 0xDFFF ) {
+                        return false;
+                    }
+                    codepoint = (((codepoint - 0xD800) << 10) | (codepoint2 - 0xDC00)) + 0x10000;
+                    p += 6;
+                }
+                encode_utf8(scratch, codepoint);
+                p += 4;
+            }
+            break;
+        default:
+            return false;
+        }
+        p += 2;
+        q = scan_unescaped(p);
+        scratch.append(p, q - p);
+    }
+
+    str = scratch.c_str();
+    str_length = scratch.length();
+    return true;
+}
+
+bool CStructuralIndex::parse_string(JsonManipulator& doc, const char* p, bool is_key) {
+    const char* str = NULL;
+    size_t str_length = 0;
+
+    if ( read_string(p, str, str_length) == false ) {
+        return false;
+    }
+    rapidjson::SizeType len = static_cast<rapidjson::SizeType>(str_length);
+    return is_key ? doc.Key(str, len, true) : doc.String(str, len, true);
+}
+
+bool CStructuralIndex::parse_atom(JsonManipulator& doc, const char* p) {
+    switch(*p) {
+    case 't':
+        return strncmp(p, "true", 4) == 0 && is_delimiter(p[4]) && doc.Bool(true);
+    case 'f':
+        return strncmp(p, "false", 5) == 0 && is_delimiter(p[5]) && doc.Bool(false);
+    case 'n':
+        return strncmp(p, "null", 4) == 0 && is_delimiter(p[4]) && doc.Null();
+    default:
+        return parse_number(doc, p);
+    }
+}
+
+bool CStructuralIndex::parse_number(JsonManipulator& doc, const char* p) {
+    static const int max_digits = 19;   // 10^19 < 2^64
+    const char* start = NULL;
+    bool minus = false;
+    bool is_double = false;
+    uint64_t significand = 0;
+    int digits = 0;             // significant digits in significand.
+    int dropped = 0;            // integer digits which are not in significand.
+    int exp_frac = 0;
+    int exp = 0;
+
+    if ( *p == '-' ) {
+        minus = true;
+        p++;
+    }
+    start = p;
+
+    // int = zero / ( digit1-9 *DIGIT )
+    if ( *p == '0' ) {
+        p++;
+    }
+    else if ( *p >= '1' && *p <= '9' ) {
+        for ( ; *p >= '0' && *p <= '9'; p++ ) {
+            const unsigned digit = static_cast<unsigned>(*p - '0');
+            // 20th digit is kept while it fits in uint64. (up to 18446744073709551615)
+            if ( digits < max_digits || (digits == max_digits && dropped == 0 &&
+                 significand <= (std::numeric_limits<uint64_t>::max() - digit) / 10) ) {
+                significand = significand * 10 + digit;
+                digits++;
+            }
+            else {
+                dropped++;
+            }
+        }
+    }
+    else {
+        return false;
+    }
+    const size_t int_length = static_cast<size_t>(p - start);
+
+    // frac = decimal-point 1*DIGIT
+    if ( *p == '.' ) {
+        p++;
+        is_double = true;
+        if ( !(*p >= '0' && *p <= '9') ) {
+            return false;
+        }
+        for ( ; *p >= '0' && *p <= '9'; p++ ) {
+            if ( digits < max_digits ) {
+                significand = significand * 10 + static_cast<unsigned>(*p - '0');
+                exp_frac--;
+                if ( significand != 0 ) {
+                    digits++;
+                }
+            }
+        }
+    }
+
+    // exp = e [ minus / plus ] 1*DIGIT
+    if ( *p == 'e' || *p == 'E' ) {
+        bool exp_minus = false;
+        p++;
+        is_double = true;
+        if ( *p == '+' || *p == '-' ) {
+            exp_minus = (*p == '-');
+            p++;
+        }
+        if ( !(*p >= '0' && *p <= '9') ) {
+            return false;
+        }
+        for ( ; *p >= '0' && *p <= '9'; p++ ) {
+            if ( exp < 100000 ) {
+                exp = exp * 10 + (*p - '0');
+            }
+        }
+        if ( exp_minus ) {
+            exp = -exp;
+        }
+    }
+
+    if ( is_delimiter(*p) == false ) {
+        return false;
+    }
+
+    if ( is_double == false && dropped == 0 ) {
+        if ( minus == false ) {
+            if ( significand <= 0xFFFFFFFFULL ) {
+                return doc.Uint(static_cast<unsigned>(significand));
+            }
+            return doc.Uint64(significand);
+        }
+        if ( significand <= 0x80000000ULL ) {
+            return doc.Int(static_cast<int>(-static_cast<int64_t>(significand)));
+        }
+        if ( significand <= 0x8000000000000000ULL ) {
+            return doc.Int64(static_cast<int64_t>(~significand + 1));
+        }
+    }
+
+    // Correctly rounded double from all digits.
+    scratch.clear();
+    for ( const char* d = start; d != p && *d != 'e' && *d != 'E'; d++ ) {
+        if ( *d != '.' ) {
+            scratch += *d;
+        }
+    }
+    double d = rapidjson::internal::StrtodFullPrecision(static_cast<double>(significand),
+                                                        exp + exp_frac + dropped,
+                                                        scratch.c_str(), scratch.length(),
+                                                        int_length, exp);
+    if ( d > (std::numeric_limits<double>::max)() ) {
+        return false;   // too big number.
+    }
+    return doc.Double(minus ? -d : d);
+}
+#endif // JSON_LIB_RAPIDJSON
+
+}   // namespace json_mng
@@ -0,0 +1,94 @@
+#ifndef _C_JSON_STRUCTURAL_INDEX_H_
+#define _C_JSON_STRUCTURAL_INDEX_H_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include <json_headers.h>
+
+namespace json_mng
+{
+    /** Two-stage JSON parser. (structural-index backend)
+     *  Stage 1 : find positions of structural characters ({}[]:,), string-openings
+     *            and scalar-starts with 64-byte bitmasks. (AVX2/PCLMUL if available)
+     *  Stage 2 : walk the positions and send SAX events to Document.
+     *  Comments are not supported. Input text must be null-terminated.
+     */
+    class CStructuralIndex {
+    public:
+        CStructuralIndex(void);
+
+        ~CStructuralIndex(void);
+
+        /** Stage 1. Returns false if a string is not closed. */
+        bool build(const char* json, size_t length);
+
+        /** Stage 2. Sends events of whole document to doc.
+         *  max_depth : maximum nesting-depth of object/array. (0 : unlimited)
+         */
+        bool populate(JsonManipulator& doc, size_t max_depth=0);
+
+        /** Stage 2 for one value starting at index[pos]. pos is moved to next index of the value. */
+        bool populate_value(JsonManipulator& doc, size_t& pos, size_t max_depth=0);
+
+        size_t size(void) const { return count; }
+
+        /** Offset of pos'th structural in the text. */
+        uint32_t at(size_t pos) const { return index[pos]; }
+
+        const char* text(void) const { return json; }
+
+        /** Character of pos'th structural. */
+        char char_at(size_t pos) const { return json[index[pos]]; }
+
+        /** Pairs open and close brackets for skip(). Returns false if they are not balanced. */
+        bool match_brackets(void);
+
+        /** Index of next structural after the value at pos. (needs match_brackets()) */
+        size_t skip(size_t pos) const {
+            const char c = char_at(pos);
+            return (c == '{' || c == '[') ? match[pos] + 1 : pos + 1;
+        }
+
+        /** Finds value-index of member key in the object at object_pos without parsing other members. */
+        bool find_member(size_t object_pos, const char* key, size_t key_length, size_t& value_pos);
+
+    private:
+        typedef struct Frame {
+            bool is_object;
+            rapidjson::SizeType count;
+        } Frame;
+
+        bool walk(JsonManipulator& doc, size_t& pos, size_t max_depth, size_t bottom);
+
+        bool read_string(const char* p, const char*& str, size_t& str_length);
+
+        bool parse_string(JsonManipulator& doc, const char* p, bool is_key);
+
+        bool parse_number(JsonManipulator& doc, const char* p);
+
+        bool parse_atom(JsonManipulator& doc, const char* p);
+
+        static bool is_delimiter(char c);
+
+    private:
+        const char* json;
+
+        size_t length;
+
+        std::vector<uint32_t> index;
+
+        size_t count;
+
+        std::vector<uint32_t> match;
+
+        std::vector<Frame> stack;
+
+        std::string scratch;
+
+    };
+}
+
+#endif // _C_JSON_STRUCTURAL_INDEX_H_
@@ -0,0 +1,286 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_FDWRITESTREAM_H_
+#define RAPIDJSON_FDWRITESTREAM_H_
+
+#include "stream.h"
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Output stream to a file descriptor using write(), for large exports.
+/*!
+    Output is buffered in a page-aligned buffer (2 MB by default) and written in
+    whole buffers.
+
+    With \c background, two buffers are used: a full buffer is written by a
+    background thread while the next one is filled.
+
+    If the fd is opened with O_DIRECT, only multiples of kAlignment are written
+    from aligned buffers; the unaligned tail is written by Close() after O_DIRECT
+    is cleared from the fd (and restored afterwards).
+
+    If a buffer can not be allocated, HasError() is set (ENOMEM) at construction and
+    all output is discarded. Without the second buffer, \c background falls back to
+    writing in the caller's thread.
+
+    Writer calls Flush() after every root value, so Flush() does not write a
+    partially filled buffer; exports of many small values still go out in whole
+    buffers. Close() (or the destructor) writes the rest and waits for the
+    background thread; call it before using the file.
+
+    \note implements Stream concept
+*/
+class FdWriteStream {
+public:
+    typedef char Ch;    //!< Character type. Only support char.
+
+    static const size_t kDefaultBufferSize = 2 * 1024 * 1024;
+    static const size_t kAlignment = 4096;  //!< Alignment of buffers and O_DIRECT writes.
+
+    FdWriteStream(int fd, size_t bufferSize = kDefaultBufferSize, bool background = false) :
+        fd_(fd), bufferSize_((bufferSize + kAlignment - 1) & ~(kAlignment - 1)), direct_(false), background_(background),
+        closed_(false), buffer_(0), other_(0), current_(0), bufferEnd_(0),
+        pending_(false), stop_(false), job_(0), jobLength_(0), error_(0)
+    {
+        RAPIDJSON_ASSERT(fd_ >= 0 && bufferSize > 0);
+#ifdef O_DIRECT
+        const int flags = ::fcntl(fd_, F_GETFL);
+        direct_ = flags >= 0 && (flags & O_DIRECT) != 0;
+#endif
+        buffer_ = AllocateBuffer();
+        if (!buffer_) {
+            // Output is discarded into scratch_: Put() never writes through a null buffer.
+            error_ = ENOMEM;
+            buffer_ = scratch_;
+            bufferSize_ = sizeof(scratch_);
+            direct_ = false;
+            background_ = false;
+        }
+        if (background_)
+            other_ = AllocateBuffer();
+        if (background_ && !other_)
+            background_ = false;
+        if (background_) {
+            pthread_mutex_init(&mutex_, 0);
+            pthread_cond_init(&cond_, 0);
+            if (pthread_create(&thread_, 0, ThreadMain, this) != 0) {
+                // Fall back to writing in the caller's thread.
+                pthread_cond_destroy(&cond_);
+                pthread_mutex_destroy(&mutex_);
+                background_ = false;
+            }
+        }
+        current_ = buffer_;
+        bufferEnd_ = buffer_ + bufferSize_;
+    }
+
+    ~FdWriteStream() {
+        Close();
+        if (buffer_ != scratch_)
+            std::free(buffer_);
+        std::free(other_);
+    }
+
+    void Put(char c) {
+        if (RAPIDJSON_UNLIKELY(current_ == bufferEnd_))
+            Submit();
+        *current_++ = c;
+    }
+
+    void PutN(char c, size_t n) {
+        size_t avail = static_cast<size_t>(bufferEnd_ - current_);
+        while (n > avail) {
+            std::memset(current_, c, avail);
+            current_ += avail;
+            n -= avail;
+            Submit();
+            avail = static_cast<size_t>(bufferEnd_ - current_);
+        }
+        std::memset(current_, c, n);
+        current_ += n;
+    }
+
+    //! Deferred to buffer-full and Close(). See class description.
+    void Flush() {}
+
+    //! Writes all buffered data and stops the background thread. The fd is not closed.
+    void Close() {
+        if (closed_)
+            return;
+        closed_ = true;
+        Submit();
+        Wait();
+
+        const size_t size = static_cast<size_t>(current_ - buffer_);
+        if (size > 0) {
+#ifdef O_DIRECT
+            const int flags = direct_ ? ::fcntl(fd_, F_GETFL) : 0;
+            if (direct_)
+                ::fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+            WriteAll(buffer_, size);
+            if (direct_)
+                ::fcntl(fd_, F_SETFL, flags);
+#else
+            WriteAll(buffer_, size);
+#endif
+            current_ = buffer_;
+        }
+
+        if (background_) {
+            pthread_mutex_lock(&mutex_);
+            stop_ = true;
+            pthread_cond_broadcast(&cond_);
+            pthread_mutex_unlock(&mutex_);
+            pthread_join(thread_, 0);
+            pthread_cond_destroy(&cond_);
+            pthread_mutex_destroy(&mutex_);
+            background_ = false;
+        }
+    }
+
+    //! Whether write() or allocation of the buffer has failed. Valid after Close(). Output after the failure is discarded.
+    bool HasError() const { return error_ != 0; }
+
+    //! errno of the first failure.
+    int GetError() const { return error_; }
+
+    // Not implemented
+    char Peek() const { RAPIDJSON_ASSERT(false); return 0; }
+    char Take() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t Tell() const { RAPIDJSON_ASSERT(false); return 0; }
+    char* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t PutEnd(char*) { RAPIDJSON_ASSERT(false); return 0; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    FdWriteStream(const FdWriteStream&);
+    FdWriteStream& operator=(const FdWriteStream&);
+
+    //! Returns 0 on failure.
+    char* AllocateBuffer() {
+        void* p = 0;
+        if (posix_memalign(&p, kAlignment, bufferSize_) != 0)
+            return 0;
+        return static_cast<char*>(p);
+    }
+
+    //! Hands the buffer to write(). With O_DIRECT the unaligned tail stays buffered.
+    void Submit() {
+        const size_t size = static_cast<size_t>(current_ - buffer_);
+        const size_t length = direct_ ? (size & ~(kAlignment - 1)) : size;
+        const size_t rest = size - length;
+        if (length == 0)
+            return;
+
+        if (background_) {
+            Wait();     // other_ is free when the previous job is done.
+            std::memcpy(other_, buffer_ + length, rest);
+            pthread_mutex_lock(&mutex_);
+            job_ = buffer_;
+            jobLength_ = length;
+            pending_ = true;
+            pthread_cond_broadcast(&cond_);
+            pthread_mutex_unlock(&mutex_);
+            char* t = buffer_; buffer_ = other_; other_ = t;
+        }
+        else {
+            WriteAll(buffer_, length);
+            std::memmove(buffer_, buffer_ + length, rest);
+        }
+        current_ = buffer_ + rest;
+        bufferEnd_ = buffer_ + bufferSize_;
+    }
+
+    //! Waits until the background thread has written the submitted buffer.
+    void Wait() {
+        if (!background_)
+            return;
+        pthread_mutex_lock(&mutex_);
+        while (pending_)
+            pthread_cond_wait(&cond_, &mutex_);
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    static void* ThreadMain(void* arg) {
+        static_cast<FdWriteStream*>(arg)->Run();
+        return 0;
+    }
+
+    void Run() {
+        pthread_mutex_lock(&mutex_);
+        for (;;) {
+            while (!pending_ && !stop_)
+                pthread_cond_wait(&cond_, &mutex_);
+            if (!pending_)
+                break;
+            const char* p = job_;
+            const size_t n = jobLength_;
+            pthread_mutex_unlock(&mutex_);
+            WriteAll(p, n);
+            pthread_mutex_lock(&mutex_);
+            pending_ = false;
+            pthread_cond_broadcast(&cond_);
+        }
+        pthread_mutex_unlock(&mutex_);
+    }
+
+    void WriteAll(const char* p, size_t n) {
+        while (n > 0 && error_ == 0) {
+            ssize_t result = ::write(fd_, p, n);
+            if (result < 0) {
+                if (errno != EINTR)
+                    error_ = errno;
+                continue;
+            }
+            p += result;
+            n -= static_cast<size_t>(result);
+        }
+    }
+
+    int fd_;
+    size_t bufferSize_;
+    bool direct_;
+    bool background_;
+    bool closed_;
+    char* buffer_;          //!< Buffer being filled.
+    char* other_;           //!< Buffer being written by the background thread.
+    char* current_;
+    char* bufferEnd_;
+
+    pthread_t thread_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    bool pending_;          //!< job_ is submitted and not written yet.
+    bool stop_;
+    const char* job_;
+    size_t jobLength_;
+    int error_;
+    char scratch_[64];      //!< Buffer of discarded output, if the buffer can not be allocated.
+};
+
+//! Implement specialized version of PutN() with memset() for better performance.
+template<>
+inline void PutN(FdWriteStream& stream, char c, size_t n) {
+    stream.PutN(c, n);
+}
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_FDWRITESTREAM_H_
@@ -0,0 +1,376 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_DISPATCH_H_
+#define RAPIDJSON_INTERNAL_DISPATCH_H_
+
+#include "../rapidjson.h"
+
+#ifdef RAPIDJSON_SIMD_DISPATCH
+#include <immintrin.h>
+
+//!@cond RAPIDJSON_HIDDEN_FROM_DOXYGEN
+#define RAPIDJSON_TARGET(isa) __attribute__((target(isa)))
+//!@endcond
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+///////////////////////////////////////////////////////////////////////////////
+// CPU feature detection
+
+//! Instruction set extensions used by the scanning kernels.
+enum CpuFeature {
+    kCpuSSE2 = 1,
+    kCpuSSE42 = 2,
+    kCpuAVX2 = 4,
+    kCpuAVX512BW = 8
+};
+
+//! Query the running processor (cpuid) for the supported \ref CpuFeature set.
+inline unsigned DetectCpuFeatures() {
+    unsigned features = 0;
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        features |= kCpuSSE2;
+    if (__builtin_cpu_supports("sse4.2"))
+        features |= kCpuSSE42;
+    if (__builtin_cpu_supports("avx2"))
+        features |= kCpuAVX2;
+    if (__builtin_cpu_supports("avx512bw"))
+        features |= kCpuAVX512BW;
+    return features;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Scanning kernels
+//
+// SkipWhitespace*    return the first character which is not ' ', '\n', '\r' or '\t'.
+// ScanUnescaped*     return the first character which is '\"', '\\' or < 0x20.
+//
+// Kernels without end pointer work on null-terminated strings: they only issue
+// loads aligned to the vector width, so a load never crosses a page boundary.
+// Bytes of the block beyond the terminator (or before p) are read, so these
+// kernels are exempt from AddressSanitizer.
+// Kernels with end pointer never read at or beyond end.
+
+inline bool IsWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+inline bool IsUnescapedStop(char c) {
+    return c == '\"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+inline const char* SkipWhitespace_Scalar(const char* p) {
+    while (IsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* SkipWhitespaceEnd_Scalar(const char* p, const char* end) {
+    while (p != end && IsWhitespace(*p))
+        ++p;
+    return p;
+}
+
+inline const char* ScanUnescaped_Scalar(const char* p) {
+    while (!IsUnescapedStop(*p))
+        ++p;
+    return p;
+}
+
+inline const char* ScanUnescapedEnd_Scalar(const char* p, const char* end) {
+    while (p != end && !IsUnescapedStop(*p))
+        ++p;
+    return p;
+}
+
+//! Scan one by one until p is aligned to \c align bytes. Returns false if a stop character is found.
+template <typename Predicate>
+inline bool ScanUntilAligned(const char*& p, size_t align, Predicate isStop) {
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + align - 1) & ~(align - 1));
+    for (; p != nextAligned; ++p)
+        if (isStop(*p))
+            return false;
+    return true;
+}
+
+inline bool IsNotWhitespace(char c) { return !IsWhitespace(c); }
+
+// SSE2
+
+RAPIDJSON_TARGET("sse2") inline unsigned WhitespaceMask_SSE2(__m128i s) {
+    __m128i x = _mm_cmpeq_epi8(s, _mm_set1_epi8(' '));
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(s, _mm_set1_epi8('\n')));
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(s, _mm_set1_epi8('\r')));
+    x = _mm_or_si128(x, _mm_cmpeq_epi8(s, _mm_set1_epi8('\t')));
+    return static_cast<unsigned short>(~_mm_movemask_epi8(x));
+}
+
+RAPIDJSON_TARGET("sse2") inline unsigned UnescapedStopMask_SSE2(__m128i s) {
+    const __m128i sp = _mm_set1_epi8(0x1F);
+    const __m128i t1 = _mm_cmpeq_epi8(s, _mm_set1_epi8('\"'));
+    const __m128i t2 = _mm_cmpeq_epi8(s, _mm_set1_epi8('\\'));
+    const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+    return static_cast<unsigned short>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(t1, t2), t3)));
+}
+
+RAPIDJSON_TARGET("sse2") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* SkipWhitespace_SSE2(const char* p) {
+    if (!ScanUntilAligned(p, 16, IsNotWhitespace))
+        return p;
+    for (;; p += 16) {
+        unsigned r = WhitespaceMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_TARGET("sse2") inline const char* SkipWhitespaceEnd_SSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned r = WhitespaceMask_SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return SkipWhitespaceEnd_Scalar(p, end);
+}
+
+RAPIDJSON_TARGET("sse2") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* ScanUnescaped_SSE2(const char* p) {
+    if (!ScanUntilAligned(p, 16, IsUnescapedStop))
+        return p;
+    for (;; p += 16) {
+        unsigned r = UnescapedStopMask_SSE2(_mm_load_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_TARGET("sse2") inline const char* ScanUnescapedEnd_SSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned r = UnescapedStopMask_SSE2(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return ScanUnescapedEnd_Scalar(p, end);
+}
+
+// SSE4.2 (pcmpistri for whitespace, strings are scanned with the SSE2 kernels)
+
+RAPIDJSON_TARGET("sse4.2") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* SkipWhitespace_SSE42(const char* p) {
+    if (!ScanUntilAligned(p, 16, IsNotWhitespace))
+        return p;
+
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+
+    for (;; p += 16) {
+        const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
+        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
+        if (r != 16)    // some of characters is non-whitespace
+            return p + r;
+    }
+}
+
+RAPIDJSON_TARGET("sse4.2") inline const char* SkipWhitespaceEnd_SSE42(const char* p, const char* end) {
+    static const char whitespace[16] = " \n\r\t";
+    const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&whitespace[0]));
+
+    for (; end - p >= 16; p += 16) {
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const int r = _mm_cmpistri(w, s, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY);
+        if (r != 16)    // some of characters is non-whitespace
+            return p + r;
+    }
+    return SkipWhitespaceEnd_Scalar(p, end);
+}
+
+// AVX2
+//
+// Null-terminated kernels load the aligned block containing p and discard the
+// bits before p, so no scalar prologue is needed and loads stay within a page.
+
+RAPIDJSON_TARGET("avx2") inline unsigned WhitespaceMask_AVX2(__m256i s) {
+    __m256i x = _mm256_cmpeq_epi8(s, _mm256_set1_epi8(' '));
+    x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\n')));
+    x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\r')));
+    x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\t')));
+    return ~static_cast<unsigned>(_mm256_movemask_epi8(x));
+}
+
+RAPIDJSON_TARGET("avx2") inline unsigned UnescapedStopMask_AVX2(__m256i s) {
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+    const __m256i t1 = _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\"'));
+    const __m256i t2 = _mm256_cmpeq_epi8(s, _mm256_set1_epi8('\\'));
+    const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(t1, t2), t3)));
+}
+
+RAPIDJSON_TARGET("avx2") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* SkipWhitespace_AVX2(const char* p) {
+    const char* a = reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & ~static_cast<size_t>(31));
+    unsigned r = WhitespaceMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(a))) >> (p - a);
+    if (r != 0)
+        return p + __builtin_ctz(r);
+    for (p = a + 32;; p += 32) {
+        r = WhitespaceMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_TARGET("avx2") inline const char* SkipWhitespaceEnd_AVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned r = WhitespaceMask_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return SkipWhitespaceEnd_SSE2(p, end);
+}
+
+RAPIDJSON_TARGET("avx2") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* ScanUnescaped_AVX2(const char* p) {
+    const char* a = reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & ~static_cast<size_t>(31));
+    unsigned r = UnescapedStopMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(a))) >> (p - a);
+    if (r != 0)
+        return p + __builtin_ctz(r);
+    for (p = a + 32;; p += 32) {
+        r = UnescapedStopMask_AVX2(_mm256_load_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+}
+
+RAPIDJSON_TARGET("avx2") inline const char* ScanUnescapedEnd_AVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned r = UnescapedStopMask_AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+        if (r != 0)
+            return p + __builtin_ctz(r);
+    }
+    return ScanUnescapedEnd_SSE2(p, end);
+}
+
+// AVX-512BW
+//
+// Bounded kernels finish the tail with a masked load, which does not fault on
+// the masked-out bytes beyond end.
+
+RAPIDJSON_TARGET("avx512bw") inline uint64_t WhitespaceMask_AVX512(__m512i s) {
+    __mmask64 x = _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8(' '));
+    x |= _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\n'));
+    x |= _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\r'));
+    x |= _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\t'));
+    return ~static_cast<uint64_t>(x);
+}
+
+RAPIDJSON_TARGET("avx512bw") inline uint64_t UnescapedStopMask_AVX512(__m512i s) {
+    __mmask64 x = _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\"'));
+    x |= _mm512_cmpeq_epi8_mask(s, _mm512_set1_epi8('\\'));
+    x |= _mm512_cmplt_epu8_mask(s, _mm512_set1_epi8(0x20));
+    return static_cast<uint64_t>(x);
+}
+
+RAPIDJSON_TARGET("avx512bw") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* SkipWhitespace_AVX512(const char* p) {
+    const char* a = reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & ~static_cast<size_t>(63));
+    uint64_t r = WhitespaceMask_AVX512(_mm512_load_si512(a)) >> (p - a);
+    if (r != 0)
+        return p + __builtin_ctzll(r);
+    for (p = a + 64;; p += 64) {
+        r = WhitespaceMask_AVX512(_mm512_load_si512(p));
+        if (r != 0)
+            return p + __builtin_ctzll(r);
+    }
+}
+
+RAPIDJSON_TARGET("avx512bw") inline const char* SkipWhitespaceEnd_AVX512(const char* p, const char* end) {
+    for (; end - p >= 64; p += 64) {
+        uint64_t r = WhitespaceMask_AVX512(_mm512_loadu_si512(p));
+        if (r != 0)
+            return p + __builtin_ctzll(r);
+    }
+    if (p == end)
+        return p;
+    const __mmask64 tail = (static_cast<uint64_t>(1) << (end - p)) - 1;   // end - p < 64
+    uint64_t r = WhitespaceMask_AVX512(_mm512_maskz_loadu_epi8(tail, p)) & tail;
+    return r != 0 ? p + __builtin_ctzll(r) : end;
+}
+
+RAPIDJSON_TARGET("avx512bw") RAPIDJSON_NO_SANITIZE_ADDRESS inline const char* ScanUnescaped_AVX512(const char* p) {
+    const char* a = reinterpret_cast<const char*>(reinterpret_cast<size_t>(p) & ~static_cast<size_t>(63));
+    uint64_t r = UnescapedStopMask_AVX512(_mm512_load_si512(a)) >> (p - a);
+    if (r != 0)
+        return p + __builtin_ctzll(r);
+    for (p = a + 64;; p += 64) {
+        r = UnescapedStopMask_AVX512(_mm512_load_si512(p));
+        if (r != 0)
+            return p + __builtin_ctzll(r);
+    }
+}
+
+RAPIDJSON_TARGET("avx512bw") inline const char* ScanUnescapedEnd_AVX512(const char* p, const char* end) {
+    for (; end - p >= 64; p += 64) {
+        uint64_t r = UnescapedStopMask_AVX512(_mm512_loadu_si512(p));
+        if (r != 0)
+            return p + __builtin_ctzll(r);
+    }
+    if (p == end)
+        return p;
+    const __mmask64 tail = (static_cast<uint64_t>(1) << (end - p)) - 1;   // end - p < 64
+    uint64_t r = UnescapedStopMask_AVX512(_mm512_maskz_loadu_epi8(tail, p)) & tail;
+    return r != 0 ? p + __builtin_ctzll(r) : end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Kernel selection
+
+//! Set of scanning kernels for one instruction set level.
+struct SimdKernels {
+    const char* (*skipWhitespace)(const char* p);
+    const char* (*skipWhitespaceEnd)(const char* p, const char* end);
+    const char* (*scanUnescaped)(const char* p);
+    const char* (*scanUnescapedEnd)(const char* p, const char* end);
+    const char* name;
+};
+
+//! Select the fastest kernels available within a \ref CpuFeature set.
+inline SimdKernels SelectSimdKernels(unsigned features) {
+    SimdKernels k = { SkipWhitespace_Scalar, SkipWhitespaceEnd_Scalar, ScanUnescaped_Scalar, ScanUnescapedEnd_Scalar, "scalar" };
+    if (features & kCpuSSE2) {
+        SimdKernels sse2 = { SkipWhitespace_SSE2, SkipWhitespaceEnd_SSE2, ScanUnescaped_SSE2, ScanUnescapedEnd_SSE2, "sse2" };
+        k = sse2;
+    }
+    if (features & kCpuSSE42) {
+        SimdKernels sse42 = { SkipWhitespace_SSE42, SkipWhitespaceEnd_SSE42, ScanUnescaped_SSE2, ScanUnescapedEnd_SSE2, "sse4.2" };
+        k = sse42;
+    }
+    if (features & kCpuAVX2) {
+        SimdKernels avx2 = { SkipWhitespace_AVX2, SkipWhitespaceEnd_AVX2, ScanUnescaped_AVX2, ScanUnescapedEnd_AVX2, "avx2" };
+        k = avx2;
+    }
+    if (features & kCpuAVX512BW) {
+        SimdKernels avx512 = { SkipWhitespace_AVX512, SkipWhitespaceEnd_AVX512, ScanUnescaped_AVX512, ScanUnescapedEnd_AVX512, "avx512bw" };
+        k = avx512;
+    }
+    return k;
+}
+
+//! Kernels for the running processor, detected once on first use.
+inline const SimdKernels& GetSimdKernels() {
+    static const SimdKernels kernels = SelectSimdKernels(DetectCpuFeatures());
+    return kernels;
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_SIMD_DISPATCH
+
+#endif // RAPIDJSON_INTERNAL_DISPATCH_H_
@@ -16,6 +16,7 @@
 #define RAPIDJSON_ITOA_
 
 #include "../rapidjson.h"
+#include "clzll.h"
 
 RAPIDJSON_NAMESPACE_BEGIN
 namespace internal {
@@ -36,80 +37,76 @@ inline const char* GetDigitsLut() {
     return cDigitsLut;
 }
 
-inline char* u32toa(uint32_t value, char* buffer) {
-    RAPIDJSON_ASSERT(buffer != 0);
+//! Number of decimal digits of value, without branches. (1 for 0)
+/*! floor(log10(v)) is estimated from the bit length as floor(bits * 1233 / 4096),
+    and corrected by one comparison with a power of 10.
+*/
+inline int DecimalLength32(uint32_t value) {
+    static const uint32_t kPow10[] = {
+        0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    const int t = static_cast<int>((64 - RAPIDJSON_CLZLL(static_cast<uint64_t>(value | 1))) * 1233 >> 12);
+    return t - (value < kPow10[t]) + 1;
+}
+
+inline int DecimalLength64(uint64_t value) {
+    static const uint64_t kPow10[] = {
+        0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+        RAPIDJSON_UINT64_C2(0x00000002, 0x540BE400), RAPIDJSON_UINT64_C2(0x00000017, 0x4876E800),   // 10^10, 10^11
+        RAPIDJSON_UINT64_C2(0x000000E8, 0xD4A51000), RAPIDJSON_UINT64_C2(0x00000918, 0x4E72A000),   // 10^12, 10^13
+        RAPIDJSON_UINT64_C2(0x00005AF3, 0x107A4000), RAPIDJSON_UINT64_C2(0x00038D7E, 0xA4C68000),   // 10^14, 10^15
+        RAPIDJSON_UINT64_C2(0x002386F2, 0x6FC10000), RAPIDJSON_UINT64_C2(0x01634578, 0x5D8A0000),   // 10^16, 10^17
+        RAPIDJSON_UINT64_C2(0x0DE0B6B3, 0xA7640000), RAPIDJSON_UINT64_C2(0x8AC72304, 0x89E80000)    // 10^18, 10^19
+    };
+    const int t = static_cast<int>((64 - RAPIDJSON_CLZLL(value | 1)) * 1233 >> 12);
+    return t - (value < kPow10[t]) + 1;
+}
 
+//! Writes exactly 8 digits (with leading zeros) of value < 10^8.
+inline void WriteEightDigits(uint32_t value, char* buffer) {
     const char* cDigitsLut = GetDigitsLut();
+    const uint32_t b = value / 10000;
+    const uint32_t c = value % 10000;
 
-    if (value < 10000) {
-        const uint32_t d1 = (value / 100) << 1;
-        const uint32_t d2 = (value % 100) << 1;
+    std::memcpy(buffer + 0, cDigitsLut + ((b / 100) << 1), 2);
+    std::memcpy(buffer + 2, cDigitsLut + ((b % 100) << 1), 2);
+    std::memcpy(buffer + 4, cDigitsLut + ((c / 100) << 1), 2);
+    std::memcpy(buffer + 6, cDigitsLut + ((c % 100) << 1), 2);
+}
 
-        if (value >= 1000)
-            *buffer++ = cDigitsLut[d1];
-        if (value >= 100)
-            *buffer++ = cDigitsLut[d1 + 1];
-        if (value >= 10)
-            *buffer++ = cDigitsLut[d2];
-        *buffer++ = cDigitsLut[d2 + 1];
-    }
-    else if (value < 100000000) {
-        // value = bbbbcccc
-        const uint32_t b = value / 10000;
+//! Writes value < 10^8 backward from end. (at most three branches)
+inline void WriteDigitsBackward(uint32_t value, char* end) {
+    const char* cDigitsLut = GetDigitsLut();
+    if (value >= 10000) {
         const uint32_t c = value % 10000;
-
-        const uint32_t d1 = (b / 100) << 1;
-        const uint32_t d2 = (b % 100) << 1;
-
-        const uint32_t d3 = (c / 100) << 1;
-        const uint32_t d4 = (c % 100) << 1;
-
-        if (value >= 10000000)
-            *buffer++ = cDigitsLut[d1];
-        if (value >= 1000000)
-            *buffer++ = cDigitsLut[d1 + 1];
-        if (value >= 100000)
-            *buffer++ = cDigitsLut[d2];
-        *buffer++ = cDigitsLut[d2 + 1];
-
-        *buffer++ = cDigitsLut[d3];
-        *buffer++ = cDigitsLut[d3 + 1];
-        *buffer++ = cDigitsLut[d4];
-        *buffer++ = cDigitsLut[d4 + 1];
+        value /= 10000;
+        end -= 4;
+        std::memcpy(end + 0, cDigitsLut + ((c / 100) << 1), 2);
+        std::memcpy(end + 2, cDigitsLut + ((c % 100) << 1), 2);
     }
-    else {
-        // value = aabbbbcccc in decimal
-
-        const uint32_t a = value / 100000000; // 1 to 42
-        value %= 100000000;
-
-        if (a >= 10) {
-            const unsigned i = a << 1;
-            *buffer++ = cDigitsLut[i];
-            *buffer++ = cDigitsLut[i + 1];
-        }
-        else
-            *buffer++ = static_cast<char>('0' + static_cast<char>(a));
-
-        const uint32_t b = value / 10000; // 0 to 9999
-        const uint32_t c = value % 10000; // 0 to 9999
-
-        const uint32_t d1 = (b / 100) << 1;
-        const uint32_t d2 = (b % 100) << 1;
+    if (value >= 100) {
+        end -= 2;
+        std::memcpy(end, cDigitsLut + ((value % 100) << 1), 2);
+        value /= 100;
+    }
+    if (value >= 10)
+        std::memcpy(end - 2, cDigitsLut + (value << 1), 2);
+    else
+        end[-1] = static_cast<char>('0' + value);
+}
 
-        const uint32_t d3 = (c / 100) << 1;
-        const uint32_t d4 = (c % 100) << 1;
+inline char* u32toa(uint32_t value, char* buffer) {
+    RAPIDJSON_ASSERT(buffer != 0);
 
-        *buffer++ = cDigitsLut[d1];
-        *buffer++ = cDigitsLut[d1 + 1];
-        *buffer++ = cDigitsLut[d2];
-        *buffer++ = cDigitsLut[d2 + 1];
-        *buffer++ = cDigitsLut[d3];
-        *buffer++ = cDigitsLut[d3 + 1];
-        *buffer++ = cDigitsLut[d4];
-        *buffer++ = cDigitsLut[d4 + 1];
+    // Length is known first, so digits are filled from the end without comparison ladder.
+    char* end = buffer + DecimalLength32(value);
+    if (value >= 100000000) {
+        WriteEightDigits(value % 100000000, end - 8);
+        WriteDigitsBackward(value / 100000000, end - 8);
     }
-    return buffer;
+    else
+        WriteDigitsBackward(value, end);
+    return end;
 }
 
 inline char* i32toa(int32_t value, char* buffer) {
@@ -125,170 +122,18 @@ inline char* i32toa(int32_t value, char* buffer) {
 
 inline char* u64toa(uint64_t value, char* buffer) {
     RAPIDJSON_ASSERT(buffer != 0);
-    const char* cDigitsLut = GetDigitsLut();
-    const uint64_t  kTen8 = 100000000;
-    const uint64_t  kTen9 = kTen8 * 10;
-    const uint64_t kTen10 = kTen8 * 100;
-    const uint64_t kTen11 = kTen8 * 1000;
-    const uint64_t kTen12 = kTen8 * 10000;
-    const uint64_t kTen13 = kTen8 * 100000;
-    const uint64_t kTen14 = kTen8 * 1000000;
-    const uint64_t kTen15 = kTen8 * 10000000;
-    const uint64_t kTen16 = kTen8 * kTen8;
-
-    if (value < kTen8) {
-        uint32_t v = static_cast<uint32_t>(value);
-        if (v < 10000) {
-            const uint32_t d1 = (v / 100) << 1;
-            const uint32_t d2 = (v % 100) << 1;
-
-            if (v >= 1000)
-                *buffer++ = cDigitsLut[d1];
-            if (v >= 100)
-                *buffer++ = cDigitsLut[d1 + 1];
-            if (v >= 10)
-                *buffer++ = cDigitsLut[d2];
-            *buffer++ = cDigitsLut[d2 + 1];
-        }
-        else {
-            // value = bbbbcccc
-            const uint32_t b = v / 10000;
-            const uint32_t c = v % 10000;
-
-            const uint32_t d1 = (b / 100) << 1;
-            const uint32_t d2 = (b % 100) << 1;
-
-            const uint32_t d3 = (c / 100) << 1;
-            const uint32_t d4 = (c % 100) << 1;
-
-            if (value >= 10000000)
-                *buffer++ = cDigitsLut[d1];
-            if (value >= 1000000)
-                *buffer++ = cDigitsLut[d1 + 1];
-            if (value >= 100000)
-                *buffer++ = cDigitsLut[d2];
-            *buffer++ = cDigitsLut[d2 + 1];
-
-            *buffer++ = cDigitsLut[d3];
-            *buffer++ = cDigitsLut[d3 + 1];
-            *buffer++ = cDigitsLut[d4];
-            *buffer++ = cDigitsLut[d4 + 1];
-        }
-    }
-    else if (value < kTen16) {
-        const uint32_t v0 = static_cast<uint32_t>(value / kTen8);
-        const uint32_t v1 = static_cast<uint32_t>(value % kTen8);
-
-        const uint32_t b0 = v0 / 10000;
-        const uint32_t c0 = v0 % 10000;
-
-        const uint32_t d1 = (b0 / 100) << 1;
-        const uint32_t d2 = (b0 % 100) << 1;
-
-        const uint32_t d3 = (c0 / 100) << 1;
-        const uint32_t d4 = (c0 % 100) << 1;
-
-        const uint32_t b1 = v1 / 10000;
-        const uint32_t c1 = v1 % 10000;
-
-        const uint32_t d5 = (b1 / 100) << 1;
-        const uint32_t d6 = (b1 % 100) << 1;
-
-        const uint32_t d7 = (c1 / 100) << 1;
-        const uint32_t d8 = (c1 % 100) << 1;
-
-        if (value >= kTen15)
-            *buffer++ = cDigitsLut[d1];
-        if (value >= kTen14)
-            *buffer++ = cDigitsLut[d1 + 1];
-        if (value >= kTen13)
-            *buffer++ = cDigitsLut[d2];
-        if (value >= kTen12)
-            *buffer++ = cDigitsLut[d2 + 1];
-        if (value >= kTen11)
-            *buffer++ = cDigitsLut[d3];
-        if (value >= kTen10)
-            *buffer++ = cDigitsLut[d3 + 1];
-        if (value >= kTen9)
-            *buffer++ = cDigitsLut[d4];
-
-        *buffer++ = cDigitsLut[d4 + 1];
-        *buffer++ = cDigitsLut[d5];
-        *buffer++ = cDigitsLut[d5 + 1];
-        *buffer++ = cDigitsLut[d6];
-        *buffer++ = cDigitsLut[d6 + 1];
-        *buffer++ = cDigitsLut[d7];
-        *buffer++ = cDigitsLut[d7 + 1];
-        *buffer++ = cDigitsLut[d8];
-        *buffer++ = cDigitsLut[d8 + 1];
+    const uint64_t kTen8 = 100000000;
+
+    // Blocks of 8 digits are written from the end with 32-bit arithmetic.
+    char* end = buffer + DecimalLength64(value);
+    char* p = end;
+    while (value >= kTen8) {
+        p -= 8;
+        WriteEightDigits(static_cast<uint32_t>(value % kTen8), p);
+        value /= kTen8;
     }
-    else {
-        const uint32_t a = static_cast<uint32_t>(value / kTen16); // 1 to 1844
-        value %= kTen16;
-
-        if (a < 10)
-            *buffer++ = static_cast<char>('0' + static_cast<char>(a));
-        else if (a < 100) {
-            const uint32_t i = a << 1;
-            *buffer++ = cDigitsLut[i];
-            *buffer++ = cDigitsLut[i + 1];
-        }
-        else if (a < 1000) {
-            *buffer++ = static_cast<char>('0' + static_cast<char>(a / 100));
-
-            const uint32_t i = (a % 100) << 1;
-            *buffer++ = cDigitsLut[i];
-            *buffer++ = cDigitsLut[i + 1];
-        }
-        else {
-            const uint32_t i = (a / 100) << 1;
-            const uint32_t j = (a % 100) << 1;
-            *buffer++ = cDigitsLut[i];
-            *buffer++ = cDigitsLut[i + 1];
-            *buffer++ = cDigitsLut[j];
-            *buffer++ = cDigitsLut[j + 1];
-        }
-
-        const uint32_t v0 = static_cast<uint32_t>(value / kTen8);
-        const uint32_t v1 = static_cast<uint32_t>(value % kTen8);
-
-        const uint32_t b0 = v0 / 10000;
-        const uint32_t c0 = v0 % 10000;
-
-        const uint32_t d1 = (b0 / 100) << 1;
-        const uint32_t d2 = (b0 % 100) << 1;
-
-        const uint32_t d3 = (c0 / 100) << 1;
-        const uint32_t d4 = (c0 % 100) << 1;
-
-        const uint32_t b1 = v1 / 10000;
-        const uint32_t c1 = v1 % 10000;
-
-        const uint32_t d5 = (b1 / 100) << 1;
-        const uint32_t d6 = (b1 % 100) << 1;
-
-        const uint32_t d7 = (c1 / 100) << 1;
-        const uint32_t d8 = (c1 % 100) << 1;
-
-        *buffer++ = cDigitsLut[d1];
-        *buffer++ = cDigitsLut[d1 + 1];
-        *buffer++ = cDigitsLut[d2];
-        *buffer++ = cDigitsLut[d2 + 1];
-        *buffer++ = cDigitsLut[d3];
-        *buffer++ = cDigitsLut[d3 + 1];
-        *buffer++ = cDigitsLut[d4];
-        *buffer++ = cDigitsLut[d4 + 1];
-        *buffer++ = cDigitsLut[d5];
-        *buffer++ = cDigitsLut[d5 + 1];
-        *buffer++ = cDigitsLut[d6];
-        *buffer++ = cDigitsLut[d6 + 1];
-        *buffer++ = cDigitsLut[d7];
-        *buffer++ = cDigitsLut[d7 + 1];
-        *buffer++ = cDigitsLut[d8];
-        *buffer++ = cDigitsLut[d8 + 1];
-    }
-
-    return buffer;
+    WriteDigitsBackward(static_cast<uint32_t>(value), p);
+    return end;
 }
 
 inline char* i64toa(int64_t value, char* buffer) {
@@ -19,6 +19,21 @@
 #include "../stream.h"
 #include "stack.h"
 
+// Cache a lazily built DFA in each regex. (lookups use C++11 atomics, without lock)
+#ifndef RAPIDJSON_REGEX_DFA
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1800)
+#define RAPIDJSON_REGEX_DFA 1
+#else
+#define RAPIDJSON_REGEX_DFA 0
+#endif
+#endif
+
+#if RAPIDJSON_REGEX_DFA
+#include <atomic>
+#include <cstring>
+#include <new>
+#endif
+
 #ifdef __clang__
 RAPIDJSON_DIAG_PUSH
 RAPIDJSON_DIAG_OFF(padded)
@@ -74,6 +89,95 @@ static const SizeType kRegexInvalidRange = ~SizeType(0);
 template <typename Encoding, typename Allocator>
 class GenericRegexSearch;
 
+#if RAPIDJSON_REGEX_DFA
+///////////////////////////////////////////////////////////////////////////////
+// RegexDfa
+
+//! Lazily built DFA of a regex for one anchoring mode, shared by all searches of the regex.
+/*!
+    A DFA state is a sorted subset of NFA states. Transitions on ASCII code
+    points are cached in the state; other code points are stepped with the NFA
+    and mapped to a cached state.
+
+    Lookups do not lock: a state is published before any transition to it.
+    States and transitions are added under a try-lock. A search that does not get
+    the lock, or finds the cache full (kMaxStates), continues with the NFA from
+    the current subset, so results never depend on the cache.
+
+    Memory is taken from CrtAllocator, as the allocator of the regex may not be
+    thread-safe.
+*/
+class RegexDfa {
+public:
+    static const SizeType kMaxStates = 256;
+    static const unsigned kTransitionSize = 128;    //!< Cached transitions per state. (ASCII)
+
+    struct State {
+        std::atomic<uint32_t> next[kTransitionSize];    //!< ((target + 1) << 1) | matched. 0 if not cached.
+        SizeType count;                                 //!< Size of subset. 0 for the dead state.
+        unsigned hash;
+        bool accepting;                                 //!< Subset has the match state.
+
+        const SizeType* Subset() const { return reinterpret_cast<const SizeType*>(this + 1); }
+    };
+
+    RegexDfa() : allocator_(), states_(), count_() {
+        states_ = static_cast<std::atomic<State*>*>(allocator_.Malloc(kMaxStates * sizeof(std::atomic<State*>)));
+        for (SizeType i = 0; i < kMaxStates; i++)
+            new (&states_[i]) std::atomic<State*>(static_cast<State*>(0));
+        lock_.clear();
+    }
+
+    ~RegexDfa() {
+        for (SizeType i = 0; i < count_; i++)
+            CrtAllocator::Free(states_[i].load(std::memory_order_relaxed));
+        CrtAllocator::Free(states_);
+    }
+
+    //! State of index, or null if it is not added yet. State 0 is the start state.
+    State* GetState(SizeType index) const {
+        return states_[index].load(std::memory_order_acquire);
+    }
+
+    bool TryLock() { return !lock_.test_and_set(std::memory_order_acquire); }
+    void Unlock() { lock_.clear(std::memory_order_release); }
+
+    //! Finds or adds the state of a sorted subset. Needs the lock. Returns kRegexInvalidState if the cache is full.
+    SizeType Insert(const SizeType* subset, SizeType count, bool accepting) {
+        unsigned hash = 2166136261u;
+        for (SizeType i = 0; i < count; i++)
+            hash = (hash ^ subset[i]) * 16777619u;
+
+        for (SizeType i = 0; i < count_; i++) {
+            const State* s = states_[i].load(std::memory_order_relaxed);
+            if (s->hash == hash && s->count == count && std::memcmp(s->Subset(), subset, count * sizeof(SizeType)) == 0)
+                return i;
+        }
+        if (count_ == kMaxStates)
+            return kRegexInvalidState;
+
+        State* s = static_cast<State*>(allocator_.Malloc(sizeof(State) + count * sizeof(SizeType)));
+        for (unsigned i = 0; i < kTransitionSize; i++)
+            new (&s->next[i]) std::atomic<uint32_t>(0u);
+        s->count = count;
+        s->hash = hash;
+        s->accepting = accepting;
+        std::memcpy(const_cast<SizeType*>(s->Subset()), subset, count * sizeof(SizeType));
+        states_[count_].store(s, std::memory_order_release);
+        return count_++;
+    }
+
+private:
+    RegexDfa(const RegexDfa&);
+    RegexDfa& operator=(const RegexDfa&);
+
+    CrtAllocator allocator_;
+    std::atomic<State*>* states_;
+    SizeType count_;            //!< Changed only under the lock.
+    std::atomic_flag lock_;
+};
+#endif // RAPIDJSON_REGEX_DFA
+
 //! Regular expression engine with subset of ECMAscript grammar.
 /*!
     Supported regular expression syntax:
@@ -121,10 +225,21 @@ public:
         GenericStringStream<Encoding> ss(source);
         DecodedStream<GenericStringStream<Encoding>, Encoding> ds(ss);
         Parse(ds);
+#if RAPIDJSON_REGEX_DFA
+        dfa_[0] = dfa_[1] = 0;
+        if (IsValid()) {
+            dfa_[0] = RAPIDJSON_NEW(RegexDfa)();
+            dfa_[1] = RAPIDJSON_NEW(RegexDfa)();
+        }
+#endif
     }
 
     ~GenericRegex()
     {
+#if RAPIDJSON_REGEX_DFA
+        RAPIDJSON_DELETE(dfa_[0]);
+        RAPIDJSON_DELETE(dfa_[1]);
+#endif
         RAPIDJSON_DELETE(ownAllocator_);
     }
 
@@ -600,6 +715,10 @@ private:
     // For SearchWithAnchoring()
     bool anchorBegin_;
     bool anchorEnd_;
+
+#if RAPIDJSON_REGEX_DFA
+    RegexDfa* dfa_[2];      //!< Indexed by anchorBegin of search.
+#endif
 };
 
 template <typename RegexType, typename Allocator = CrtAllocator>
@@ -613,11 +732,6 @@ public:
         state0_(allocator, 0), state1_(allocator, 0), stateSet_()
     {
         RAPIDJSON_ASSERT(regex_.IsValid());
-        if (!allocator_)
-            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
-        stateSet_ = static_cast<unsigned*>(allocator_->Malloc(GetStateSetSize()));
-        state0_.template Reserve<SizeType>(regex_.stateCount_);
-        state1_.template Reserve<SizeType>(regex_.stateCount_);
     }
 
     ~GenericRegexSearch() {
@@ -653,12 +767,21 @@ private:
     bool SearchWithAnchoring(InputStream& is, bool anchorBegin, bool anchorEnd) {
         DecodedStream<InputStream, Encoding> ds(is);
 
+#if RAPIDJSON_REGEX_DFA
+        return DfaSearch(ds, anchorBegin, anchorEnd);
+#else
+        Prepare();
         state0_.Clear();
-        Stack<Allocator> *current = &state0_, *next = &state1_;
-        const size_t stateSetSize = GetStateSetSize();
-        std::memset(stateSet_, 0, stateSetSize);
+        std::memset(stateSet_, 0, GetStateSetSize());
+        bool matched = AddState(state0_, regex_.root_);
+        return NfaSearch(ds, &state0_, &state1_, matched, anchorBegin, anchorEnd);
+#endif
+    }
 
-        bool matched = AddState(*current, regex_.root_);
+    //! Runs the NFA from the states in current.
+    template <typename DecodedInputStream>
+    bool NfaSearch(DecodedInputStream& ds, Stack<Allocator>* current, Stack<Allocator>* next, bool matched, bool anchorBegin, bool anchorEnd) {
+        const size_t stateSetSize = GetStateSetSize();
         unsigned codepoint;
         while (!current->Empty() && (codepoint = ds.Take()) != 0) {
             std::memset(stateSet_, 0, stateSetSize);
@@ -683,6 +806,107 @@ private:
         return matched;
     }
 
+#if RAPIDJSON_REGEX_DFA
+    //! Runs the cached DFA, and builds missing states on the way. Same result as NfaSearch().
+    template <typename DecodedInputStream>
+    bool DfaSearch(DecodedInputStream& ds, bool anchorBegin, bool anchorEnd) {
+        RegexDfa& dfa = *regex_.dfa_[anchorBegin ? 1 : 0];
+        RegexDfa::State* s = dfa.GetState(0);
+        bool matched;
+
+        if (!s) {
+            Prepare();
+            state0_.Clear();
+            std::memset(stateSet_, 0, GetStateSetSize());
+            matched = AddState(state0_, regex_.root_);
+            SizeType index = Publish(dfa, state0_, 0, 0, false);
+            if (index == kRegexInvalidState)
+                return NfaSearch(ds, &state0_, &state1_, matched, anchorBegin, anchorEnd);
+            s = dfa.GetState(index);
+        }
+
+        matched = s->accepting;
+        unsigned codepoint;
+        while (s->count != 0 && (codepoint = ds.Take()) != 0) {
+            uint32_t next = codepoint < RegexDfa::kTransitionSize ? s->next[codepoint].load(std::memory_order_acquire) : 0u;
+            if (next == 0) {
+                Prepare();
+                matched = Step(*s, codepoint, state0_, anchorBegin);
+                SizeType index = Publish(dfa, state0_, s, codepoint, matched);
+                if (index == kRegexInvalidState) {
+                    if (!anchorEnd && matched)
+                        return true;
+                    return NfaSearch(ds, &state0_, &state1_, matched, anchorBegin, anchorEnd);
+                }
+                next = ((index + 1) << 1) | (matched ? 1u : 0u);
+            }
+            matched = (next & 1) != 0;
+            s = dfa.GetState((next >> 1) - 1);
+            if (!anchorEnd && matched)
+                return true;
+        }
+
+        return matched;
+    }
+
+    //! NFA step from the subset of a DFA state. Returns whether the match state is reached.
+    bool Step(const RegexDfa::State& from, unsigned codepoint, Stack<Allocator>& next, bool anchorBegin) {
+        std::memset(stateSet_, 0, GetStateSetSize());
+        next.Clear();
+        bool matched = false;
+        const SizeType* subset = from.Subset();
+        for (SizeType i = 0; i < from.count; i++) {
+            const State& sr = regex_.GetState(subset[i]);
+            if (sr.codepoint == codepoint ||
+                sr.codepoint == RegexType::kAnyCharacterClass || 
+                (sr.codepoint == RegexType::kRangeCharacterClass && MatchRange(sr.rangeStart, codepoint)))
+            {
+                matched = AddState(next, sr.out) || matched;
+            }
+            if (!anchorBegin)
+                AddState(next, regex_.root_);
+        }
+        return matched;
+    }
+
+    //! Adds subset as a DFA state, and the transition to it from (from, codepoint) if given.
+    //! Returns kRegexInvalidState if the lock is busy or the cache is full.
+    SizeType Publish(RegexDfa& dfa, Stack<Allocator>& subset, RegexDfa::State* from, unsigned codepoint, bool matched) {
+        if (!dfa.TryLock())
+            return kRegexInvalidState;
+
+        // Sorted, so that a subset reached in other order maps to the same state.
+        SizeType* begin = subset.template Bottom<SizeType>();
+        const SizeType count = static_cast<SizeType>(subset.GetSize() / sizeof(SizeType));
+        bool accepting = false;
+        for (SizeType i = 0; i < count; i++) {
+            const SizeType v = begin[i];
+            SizeType j = i;
+            for (; j > 0 && begin[j - 1] > v; j--)
+                begin[j] = begin[j - 1];
+            begin[j] = v;
+            accepting = accepting || regex_.GetState(v).out == kRegexInvalidState;
+        }
+
+        SizeType index = dfa.Insert(begin, count, accepting);
+        if (index != kRegexInvalidState && from && codepoint < RegexDfa::kTransitionSize)
+            from->next[codepoint].store(((index + 1) << 1) | (matched ? 1u : 0u), std::memory_order_release);
+        dfa.Unlock();
+        return index;
+    }
+#endif // RAPIDJSON_REGEX_DFA
+
+    //! Allocates buffers of the NFA at first use.
+    void Prepare() {
+        if (stateSet_)
+            return;
+        if (!allocator_)
+            ownAllocator_ = allocator_ = RAPIDJSON_NEW(Allocator)();
+        stateSet_ = static_cast<unsigned*>(allocator_->Malloc(GetStateSetSize()));
+        state0_.template Reserve<SizeType>(regex_.stateCount_);
+        state1_.template Reserve<SizeType>(regex_.stateCount_);
+    }
+
     size_t GetStateSetSize() const {
         return (regex_.stateCount_ + 31) / 32 * 4;
     }
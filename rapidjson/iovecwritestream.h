@@ -0,0 +1,253 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_IOVECWRITESTREAM_H_
+#define RAPIDJSON_IOVECWRITESTREAM_H_
+
+#include "writer.h"
+#include <cerrno>
+#include <sys/uio.h>
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+//! Scatter-gather output stream to a file descriptor using writev().
+/*!
+    Generated characters (punctuation, numbers, escapes, short strings) are staged
+    in fixed-size blocks, which are never moved. Runs of at least \c referenceLength
+    characters given to Write() are not copied; the iovec list points to the
+    caller's bytes directly. Those bytes must stay valid until the next Flush().
+    Writer flushes at the end of the root value.
+
+    If a block can not be allocated, HasError() is set (ENOMEM) and later output
+    is discarded.
+
+    Writer<IovecWriteStream> hands unescaped runs of strings to Write(), so long
+    strings of a document are sent from the document itself.
+
+    \note implements Stream concept
+*/
+class IovecWriteStream {
+public:
+    typedef char Ch;    //!< Character type. Only support char.
+
+    static const size_t kDefaultBlockSize = 64 * 1024;
+    static const size_t kDefaultReferenceLength = 128;
+
+    IovecWriteStream(int fd, size_t blockSize = kDefaultBlockSize, size_t referenceLength = kDefaultReferenceLength) :
+        fd_(fd), blockSize_(blockSize), referenceLength_(referenceLength), blockCount_(0), blockIndex_(0),
+        current_(0), blockEnd_(0), fragment_(0), iovCount_(0), error_(0)
+    {
+        RAPIDJSON_ASSERT(fd_ >= 0 && blockSize_ > 0);
+        SetBlock(0);
+    }
+
+    ~IovecWriteStream() {
+        for (size_t i = 0; i < blockCount_; i++)
+            std::free(blocks_[i]);
+    }
+
+    void Put(char c) {
+        if (RAPIDJSON_UNLIKELY(current_ == blockEnd_))
+            NextBlock();
+        *current_++ = c;
+    }
+
+    void PutN(char c, size_t n) {
+        size_t avail = static_cast<size_t>(blockEnd_ - current_);
+        while (n > avail) {
+            std::memset(current_, c, avail);
+            current_ += avail;
+            n -= avail;
+            NextBlock();
+            avail = static_cast<size_t>(blockEnd_ - current_);
+        }
+        std::memset(current_, c, n);
+        current_ += n;
+    }
+
+    //! Writes characters, by reference if the run is long enough.
+    void Write(const char* str, size_t length) {
+        if (length >= referenceLength_) {
+            Reference(str, length);
+            return;
+        }
+        size_t avail = static_cast<size_t>(blockEnd_ - current_);
+        while (length > avail) {
+            std::memcpy(current_, str, avail);
+            current_ += avail;
+            str += avail;
+            length -= avail;
+            NextBlock();
+            avail = static_cast<size_t>(blockEnd_ - current_);
+        }
+        std::memcpy(current_, str, length);
+        current_ += length;
+    }
+
+    //! Writes characters without copy. They must be valid until next Flush().
+    void Reference(const char* str, size_t length) {
+        CloseFragment();
+        if (length > 0)
+            AddIovec(str, length);
+    }
+
+    void Flush() {
+        CloseFragment();
+        WriteIovecs();
+        SetBlock(0);
+    }
+
+    //! Whether writev() or allocation of a block has failed. Output after the failure is discarded.
+    bool HasError() const { return error_ != 0; }
+
+    //! errno of the first failure.
+    int GetError() const { return error_; }
+
+    // Not implemented
+    char Peek() const { RAPIDJSON_ASSERT(false); return 0; }
+    char Take() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t Tell() const { RAPIDJSON_ASSERT(false); return 0; }
+    char* PutBegin() { RAPIDJSON_ASSERT(false); return 0; }
+    size_t PutEnd(char*) { RAPIDJSON_ASSERT(false); return 0; }
+
+private:
+    // Prohibit copy constructor & assignment operator.
+    IovecWriteStream(const IovecWriteStream&);
+    IovecWriteStream& operator=(const IovecWriteStream&);
+
+    static const size_t kMaxBlocks = 16;
+    static const size_t kMaxIovecs = 256;
+
+    void SetBlock(size_t index) {
+        RAPIDJSON_ASSERT(index <= blockCount_ && index < kMaxBlocks);
+        if (index == blockCount_) {
+            char* block = static_cast<char*>(std::malloc(blockSize_));
+            if (!block) {
+                if (error_ == 0)
+                    error_ = ENOMEM;
+                Discard();
+                return;
+            }
+            blocks_[blockCount_++] = block;
+        }
+        blockIndex_ = index;
+        current_ = fragment_ = blocks_[index];
+        blockEnd_ = current_ + blockSize_;
+    }
+
+    //! Stages output in scratch_, which is overwritten: Put() never writes through a null block.
+    void Discard() {
+        iovCount_ = 0;
+        current_ = fragment_ = scratch_;
+        blockEnd_ = scratch_ + sizeof(scratch_);
+    }
+
+    void NextBlock() {
+        // Staged bytes are written out when all blocks are in use.
+        if (blockEnd_ == scratch_ + sizeof(scratch_))
+            Discard();
+        else if (blockIndex_ + 1 == kMaxBlocks)
+            Flush();
+        else {
+            CloseFragment();
+            SetBlock(blockIndex_ + 1);
+        }
+    }
+
+    void CloseFragment() {
+        if (current_ != fragment_) {
+            AddIovec(fragment_, static_cast<size_t>(current_ - fragment_));
+            fragment_ = current_;
+        }
+    }
+
+    void AddIovec(const char* base, size_t length) {
+        if (iovCount_ == kMaxIovecs)
+            WriteIovecs();
+        iov_[iovCount_].iov_base = const_cast<char*>(base);
+        iov_[iovCount_].iov_len = length;
+        iovCount_++;
+    }
+
+    void WriteIovecs() {
+        struct iovec* iov = iov_;
+        int count = static_cast<int>(iovCount_);
+        iovCount_ = 0;
+
+        while (count > 0 && error_ == 0) {
+            ssize_t result = ::writev(fd_, iov, count);
+            if (result < 0) {
+                if (errno != EINTR)
+                    error_ = errno;
+                continue;
+            }
+            // Skip written iovecs, and the written head of a partially written one.
+            size_t written = static_cast<size_t>(result);
+            while (count > 0 && written >= iov->iov_len) {
+                written -= iov->iov_len;
+                iov++;
+                count--;
+            }
+            if (count > 0) {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+                iov->iov_len -= written;
+            }
+        }
+    }
+
+    int fd_;
+    size_t blockSize_;
+    size_t referenceLength_;
+    char* blocks_[kMaxBlocks];
+    size_t blockCount_;
+    size_t blockIndex_;
+    char* current_;
+    char* blockEnd_;
+    char* fragment_;        //!< Staged bytes not yet in iov_, from fragment_ to current_.
+    struct iovec iov_[kMaxIovecs];
+    size_t iovCount_;
+    int error_;
+    char scratch_[64];      //!< Buffer of discarded output, if a block can not be allocated.
+};
+
+//! Implement specialized version of PutN() with memset() for better performance.
+template<>
+inline void PutN(IovecWriteStream& stream, char c, size_t n) {
+    stream.PutN(c, n);
+}
+
+//! Unescaped runs of strings go to IovecWriteStream::Write(), which references long ones.
+template<>
+inline bool Writer<IovecWriteStream>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    if (!RAPIDJSON_LIKELY(is.Tell() < length))
+        return false;
+
+    const char* p = is.src_;
+    const char* end = is.head_ + length;
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+    const char* q = internal::GetSimdKernels().scanUnescapedEnd(p, end);
+#else
+    const char* q = p;
+    while (q != end && static_cast<unsigned char>(*q) >= 0x20 && *q != '\"' && *q != '\\')
+        q++;
+#endif
+    os_->Write(p, static_cast<size_t>(q - p));
+
+    is.src_ = q;
+    return RAPIDJSON_LIKELY(is.Tell() < length);
+}
+
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_IOVECWRITESTREAM_H_
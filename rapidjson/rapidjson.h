@@ -193,6 +193,29 @@
 //!@endcond
 #endif // RAPIDJSON_FORCEINLINE
 
+///////////////////////////////////////////////////////////////////////////////
+// RAPIDJSON_NO_SANITIZE_ADDRESS
+
+//! Exempts a function from AddressSanitizer checks.
+/*! For scanning code that deliberately reads past the terminator of a string
+    within the same aligned block or page. Such reads never fault, but ASan
+    reports them as heap-buffer-overflow.
+*/
+#ifndef RAPIDJSON_NO_SANITIZE_ADDRESS
+//!@cond RAPIDJSON_HIDDEN_FROM_DOXYGEN
+#if defined(__SANITIZE_ADDRESS__)
+#define RAPIDJSON_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define RAPIDJSON_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef RAPIDJSON_NO_SANITIZE_ADDRESS
+#define RAPIDJSON_NO_SANITIZE_ADDRESS
+#endif
+//!@endcond
+#endif // RAPIDJSON_NO_SANITIZE_ADDRESS
+
 ///////////////////////////////////////////////////////////////////////////////
 // RAPIDJSON_ENDIAN
 #define RAPIDJSON_LITTLEENDIAN  0   //!< Little endian machine
@@ -348,8 +371,29 @@
     If any of these symbols is defined, RapidJSON defines the macro
     \c RAPIDJSON_SIMD to indicate the availability of the optimized code.
 */
+/*! \def RAPIDJSON_SIMD_DISPATCH
+    \ingroup RAPIDJSON_CONFIG
+    \brief Select SIMD kernels at runtime.
+
+    Instead of fixing the instruction set at compile time, all x86 kernels
+    are compiled in and the fastest one supported by the running processor
+    is selected once (cpuid) on first use.
+    \code
+    #define RAPIDJSON_SIMD_DISPATCH
+    \endcode
+
+    Requires GCC or Clang on x86/x86-64, and is ignored otherwise.
+    \c RAPIDJSON_SIMD_DISPATCH takes precedence over \c RAPIDJSON_SSE2 and
+    \c RAPIDJSON_SSE42.
+*/
+#if defined(RAPIDJSON_SIMD_DISPATCH) \
+    && !(defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#undef RAPIDJSON_SIMD_DISPATCH
+#endif
+
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) \
-    || defined(RAPIDJSON_NEON) || defined(RAPIDJSON_DOXYGEN_RUNNING)
+    || defined(RAPIDJSON_NEON) || defined(RAPIDJSON_SIMD_DISPATCH) \
+    || defined(RAPIDJSON_DOXYGEN_RUNNING)
 #define RAPIDJSON_SIMD
 #endif
 
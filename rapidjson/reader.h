@@ -30,7 +30,9 @@
 #include <intrin.h>
 #pragma intrinsic(_BitScanForward)
 #endif
-#ifdef RAPIDJSON_SSE42
+#ifdef RAPIDJSON_SIMD_DISPATCH
+#include "internal/dispatch.h"
+#elif defined(RAPIDJSON_SSE42)
 #include <nmmintrin.h>
 #elif defined(RAPIDJSON_SSE2)
 #include <emmintrin.h>
@@ -149,7 +151,7 @@ enum ParseFlag {
     kParseValidateEncodingFlag = 2, //!< Validate encoding of JSON strings.
     kParseIterativeFlag = 4,        //!< Iterative(constant complexity in terms of function call stack size) parsing.
     kParseStopWhenDoneFlag = 8,     //!< After parsing a complete JSON root from stream, stop further processing the rest of stream. When this flag is used, parser will not generate kParseErrorDocumentRootNotSingular error.
-    kParseFullPrecisionFlag = 16,   //!< Parse number in full precision (but slower).
+    kParseFullPrecisionFlag = 16,   //!< Parse number in full precision (correctly rounded, Eisel-Lemire fast path).
     kParseCommentsFlag = 32,        //!< Allow one-line (//) and multi-line (/**/) comments.
     kParseNumbersAsStringsFlag = 64,    //!< Parse all numbers (ints/doubles) as strings.
     kParseTrailingCommasFlag = 128, //!< Allow trailing commas at the end of objects and arrays.
@@ -277,7 +279,23 @@ inline const char* SkipWhitespace(const char* p, const char* end) {
     return p;
 }
 
-#ifdef RAPIDJSON_SSE42
+#ifdef RAPIDJSON_SIMD_DISPATCH
+//! Skip whitespace with the kernel selected for the running processor.
+inline const char *SkipWhitespace_SIMD(const char* p) {
+    // Fast return for single non-whitespace
+    if (!internal::IsWhitespace(*p))
+        return p;
+    return internal::GetSimdKernels().skipWhitespace(p);
+}
+
+inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p == end || !internal::IsWhitespace(*p))
+        return p;
+    return internal::GetSimdKernels().skipWhitespaceEnd(p, end);
+}
+
+#elif defined(RAPIDJSON_SSE42)
 //! Skip whitespace with SSE 4.2 pcmpistrm instruction, testing 16 8-byte characters at once.
 inline const char *SkipWhitespace_SIMD(const char* p) {
     // Fast return for single non-whitespace
@@ -515,6 +533,76 @@ template<> inline void SkipWhitespace(EncodedInputStream<UTF8<>, MemoryStream>&
 }
 #endif // RAPIDJSON_SIMD
 
+///////////////////////////////////////////////////////////////////////////////
+// TakeEightDigits
+
+//! Take 8 ASCII digits from a stream at once.
+/*! \param is A input stream.
+    \param value Value of the 8 digits.
+    \return false if next 8 characters are not all digits, or the stream cannot be read
+            8 characters at once. Nothing is taken in that case.
+    \note This function has SWAR specialization for contiguous UTF-8 streams.
+*/
+template<typename InputStream>
+inline bool TakeEightDigits(InputStream& is, uint32_t* value) {
+    (void)is;
+    (void)value;
+    return false;
+}
+
+#if RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+//! Parse 8 ASCII digits with SWAR (SIMD within a register) operations on a 64-bit word.
+/*! The word may extend past the terminator of a null-terminated string (within
+    the page, see \ref IsEightBytesInPage), so it is exempt from AddressSanitizer.
+*/
+RAPIDJSON_NO_SANITIZE_ADDRESS inline bool ParseEightDigits_SWAR(const char* p, uint32_t* value) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+
+    // Each byte must be 0x30-0x39: high nibble is 3, and adding 6 does not carry into it.
+    const uint64_t kHighNibbles = RAPIDJSON_UINT64_C2(0xF0F0F0F0, 0xF0F0F0F0);
+    if (((v & kHighNibbles) | (((v + RAPIDJSON_UINT64_C2(0x06060606, 0x06060606)) & kHighNibbles) >> 4)) !=
+        RAPIDJSON_UINT64_C2(0x33333333, 0x33333333))
+        return false;
+
+    // First character is in the lowest byte. Combine 1 -> 2 -> 4 -> 8 digits.
+    v -= RAPIDJSON_UINT64_C2(0x30303030, 0x30303030);
+    v = (v * 10) + (v >> 8);
+    v = (((v & RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF)) * RAPIDJSON_UINT64_C2(0x000F4240, 0x00000064)) +       // 10^6, 10^2
+         (((v >> 16) & RAPIDJSON_UINT64_C2(0x000000FF, 0x000000FF)) * RAPIDJSON_UINT64_C2(0x00002710, 0x00000001))) >> 32; // 10^4, 1
+    *value = static_cast<uint32_t>(v);
+    return true;
+}
+
+//! 8 bytes from p do not cross a page, so they can be read from null-terminated string.
+inline bool IsEightBytesInPage(const char* p) {
+    return (reinterpret_cast<uintptr_t>(p) & 4095) <= 4096 - 8;
+}
+
+//! Template function specialization for StringStream
+template<> inline bool TakeEightDigits(StringStream& is, uint32_t* value) {
+    if (!IsEightBytesInPage(is.src_) || !ParseEightDigits_SWAR(is.src_, value))
+        return false;
+    is.src_ += 8;
+    return true;
+}
+
+//! Template function specialization for InsituStringStream
+template<> inline bool TakeEightDigits(InsituStringStream& is, uint32_t* value) {
+    if (!IsEightBytesInPage(is.src_) || !ParseEightDigits_SWAR(is.src_, value))
+        return false;
+    is.src_ += 8;
+    return true;
+}
+
+template<> inline bool TakeEightDigits(EncodedInputStream<UTF8<>, MemoryStream>& is, uint32_t* value) {
+    if (is.is_.end_ - is.is_.src_ < 8 || !ParseEightDigits_SWAR(is.is_.src_, value))
+        return false;
+    is.is_.src_ += 8;
+    return true;
+}
+#endif // RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericReader
 
@@ -1059,7 +1147,32 @@ private:
             // Do nothing for generic version
     }
 
-#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+    // StringStream -> StackStream<char>
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+        const char* q = internal::GetSimdKernels().scanUnescaped(p);
+        SizeType length = static_cast<SizeType>(q - p);
+        if (length != 0)
+            std::memcpy(os.Push(length), p, length);
+        is.src_ = q;
+    }
+
+    // InsituStringStream -> InsituStringStream
+    static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+
+        char* p = is.src_;
+        char* q = const_cast<char*>(internal::GetSimdKernels().scanUnescaped(p));
+        size_t length = static_cast<size_t>(q - p);
+        // When read/write pointers are the same, just skip unescaped characters
+        if (is.dst_ != p)
+            std::memmove(is.dst_, p, length);
+        is.src_ = q;
+        is.dst_ += length;
+    }
+#elif defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
     // StringStream -> StackStream<char>
     static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
         const char* p = is.src_;
@@ -1404,6 +1517,7 @@ private:
         RAPIDJSON_FORCEINLINE Ch Peek() const { return is.Peek(); }
         RAPIDJSON_FORCEINLINE Ch TakePush() { return is.Take(); }
         RAPIDJSON_FORCEINLINE Ch Take() { return is.Take(); }
+        RAPIDJSON_FORCEINLINE bool TakeEightDigits(uint32_t* value) { return RAPIDJSON_NAMESPACE::TakeEightDigits(is, value); }
         RAPIDJSON_FORCEINLINE void Push(char) {}
 
         size_t Tell() { return is.Tell(); }
@@ -1427,6 +1541,15 @@ private:
             return Base::is.Take();
         }
 
+        RAPIDJSON_FORCEINLINE bool TakeEightDigits(uint32_t* value) {
+            if (!Base::TakeEightDigits(value))
+                return false;
+            char* digits = static_cast<char*>(stackStream.Push(8));
+            for (uint32_t v = *value, k = 8; k > 0; v /= 10)
+                digits[--k] = static_cast<char>('0' + v % 10);
+            return true;
+        }
+
         RAPIDJSON_FORCEINLINE void Push(char c) {
             stackStream.Put(c);
         }
@@ -1480,30 +1603,49 @@ private:
         else if (RAPIDJSON_LIKELY(s.Peek() >= '1' && s.Peek() <= '9')) {
             i = static_cast<unsigned>(s.TakePush() - '0');
 
-            if (minus)
-                while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
-                    if (RAPIDJSON_UNLIKELY(i >= 214748364)) { // 2^31 = 2147483648
-                        if (RAPIDJSON_LIKELY(i != 214748364 || s.Peek() > '8')) {
-                            i64 = i;
-                            use64bit = true;
-                            break;
+            // Take 8 digits at once while the 64-bit integer cannot overflow.
+            // (2^63 - 10^8) / 10^8 = 92233720367, (2^64 - 10^8) / 10^8 = 184467440736
+            uint32_t digits8;
+            if (s.TakeEightDigits(&digits8)) {
+                const uint64_t maxBatch = minus ? RAPIDJSON_UINT64_C2(0x00000015, 0x798EE22F) : RAPIDJSON_UINT64_C2(0x0000002A, 0xF31DC460);
+                i64 = i * 100000000u + digits8;
+                significandDigit += 8;
+                while (i64 <= maxBatch && s.TakeEightDigits(&digits8)) {
+                    i64 = i64 * 100000000u + digits8;
+                    significandDigit += 8;
+                }
+                if (i64 > (minus ? 0x80000000u : 0xFFFFFFFFu))
+                    use64bit = true;
+                else
+                    i = static_cast<unsigned>(i64);
+            }
+
+            if (!use64bit) {
+                if (minus)
+                    while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
+                        if (RAPIDJSON_UNLIKELY(i >= 214748364)) { // 2^31 = 2147483648
+                            if (RAPIDJSON_LIKELY(i != 214748364 || s.Peek() > '8')) {
+                                i64 = i;
+                                use64bit = true;
+                                break;
+                            }
                         }
+                        i = i * 10 + static_cast<unsigned>(s.TakePush() - '0');
+                        significandDigit++;
                     }
-                    i = i * 10 + static_cast<unsigned>(s.TakePush() - '0');
-                    significandDigit++;
-                }
-            else
-                while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
-                    if (RAPIDJSON_UNLIKELY(i >= 429496729)) { // 2^32 - 1 = 4294967295
-                        if (RAPIDJSON_LIKELY(i != 429496729 || s.Peek() > '5')) {
-                            i64 = i;
-                            use64bit = true;
-                            break;
+                else
+                    while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
+                        if (RAPIDJSON_UNLIKELY(i >= 429496729)) { // 2^32 - 1 = 4294967295
+                            if (RAPIDJSON_LIKELY(i != 429496729 || s.Peek() > '5')) {
+                                i64 = i;
+                                use64bit = true;
+                                break;
+                            }
                         }
+                        i = i * 10 + static_cast<unsigned>(s.TakePush() - '0');
+                        significandDigit++;
                     }
-                    i = i * 10 + static_cast<unsigned>(s.TakePush() - '0');
-                    significandDigit++;
-                }
+            }
         }
         // Parse NaN or Infinity here
         else if ((parseFlags & kParseNanAndInfFlag) && RAPIDJSON_LIKELY((s.Peek() == 'I' || s.Peek() == 'N'))) {
@@ -1581,6 +1723,18 @@ private:
                 if (!use64bit)
                     i64 = i;
 
+                // Take 8 digits at once while the result is within 2^53 - 1. ((2^53 - 10^8) / 10^8 = 90071991)
+                uint32_t digits8;
+                while (i64 <= 90071991u && s.TakeEightDigits(&digits8)) {
+                    if (i64 != 0)
+                        significandDigit += 8;
+                    else
+                        for (uint32_t v = digits8; v != 0; v /= 10)  // leading zeros are not significant
+                            significandDigit++;
+                    i64 = i64 * 100000000u + digits8;
+                    expFrac -= 8;
+                }
+
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                     if (i64 > RAPIDJSON_UINT64_C2(0x1FFFFF, 0xFFFFFFFF)) // 2^53 - 1 for fast path
                         break;
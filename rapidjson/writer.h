@@ -21,6 +21,7 @@
 #include "internal/stack.h"
 #include "internal/strfunc.h"
 #include "internal/dtoa.h"
+#include "internal/schubfach.h"
 #include "internal/itoa.h"
 #include "stringbuffer.h"
 #include <new>      // placement new
@@ -29,7 +30,9 @@
 #include <intrin.h>
 #pragma intrinsic(_BitScanForward)
 #endif
-#ifdef RAPIDJSON_SSE42
+#ifdef RAPIDJSON_SIMD_DISPATCH
+#include "internal/dispatch.h"
+#elif defined(RAPIDJSON_SSE42)
 #include <nmmintrin.h>
 #elif defined(RAPIDJSON_SSE2)
 #include <emmintrin.h>
@@ -67,6 +70,7 @@ enum WriteFlag {
     kWriteNoFlags = 0,              //!< No flags are set.
     kWriteValidateEncodingFlag = 1, //!< Validate encoding of JSON strings.
     kWriteNanAndInfFlag = 2,        //!< Allow writing of Infinity, -Infinity and NaN.
+    kWriteShortestDoubleFlag = 4,   //!< Write double with the shortest round-trip digits (Schubfach) instead of Grisu2.
     kWriteDefaultFlags = RAPIDJSON_WRITE_DEFAULT_FLAGS  //!< Default write flags. Can be customized by defining RAPIDJSON_WRITE_DEFAULT_FLAGS
 };
 
@@ -193,6 +197,14 @@ public:
     */
     bool Double(double d)       { Prefix(kNumberType); return EndValue(WriteDouble(d)); }
 
+    //! Writes the given \c float value with the shortest digits which round-trip in float precision
+    /*!
+        \param f The value to be written.
+        \return Whether it is succeed.
+        \note Float is not a handler event. Double() writes it with double precision digits.
+    */
+    bool Float(float f)         { Prefix(kNumberType); return EndValue(WriteFloat(f)); }
+
     bool RawNumber(const Ch* str, SizeType length, bool copy = false) {
         RAPIDJSON_ASSERT(str != 0);
         (void)copy;
@@ -367,7 +379,20 @@ protected:
         }
 
         char buffer[25];
-        char* end = internal::dtoa(d, buffer, maxDecimalPlaces_);
+        char* end = (writeFlags & kWriteShortestDoubleFlag) ?
+            internal::dtoaShortest(d, buffer, maxDecimalPlaces_) : internal::dtoa(d, buffer, maxDecimalPlaces_);
+        PutReserve(*os_, static_cast<size_t>(end - buffer));
+        for (char* p = buffer; p != end; ++p)
+            PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(*p));
+        return true;
+    }
+
+    bool WriteFloat(float f) {
+        if (internal::Double(static_cast<double>(f)).IsNanOrInf())
+            return WriteDouble(static_cast<double>(f));
+
+        char buffer[25];
+        char* end = internal::ftoaShortest(f, buffer, maxDecimalPlaces_);
         PutReserve(*os_, static_cast<size_t>(end - buffer));
         for (char* p = buffer; p != end; ++p)
             PutUnsafe(*os_, static_cast<typename OutputStream::Ch>(*p));
@@ -565,12 +590,42 @@ inline bool Writer<StringBuffer>::WriteDouble(double d) {
     }
     
     char *buffer = os_->Push(25);
-    char* end = internal::dtoa(d, buffer, maxDecimalPlaces_);
+    char* end = (kWriteDefaultFlags & kWriteShortestDoubleFlag) ?
+        internal::dtoaShortest(d, buffer, maxDecimalPlaces_) : internal::dtoa(d, buffer, maxDecimalPlaces_);
     os_->Pop(static_cast<size_t>(25 - (end - buffer)));
     return true;
 }
 
-#if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
+template<>
+inline bool Writer<StringBuffer>::WriteFloat(float f) {
+    if (internal::Double(static_cast<double>(f)).IsNanOrInf())
+        return WriteDouble(static_cast<double>(f));
+
+    char *buffer = os_->Push(25);
+    char* end = internal::ftoaShortest(f, buffer, maxDecimalPlaces_);
+    os_->Pop(static_cast<size_t>(25 - (end - buffer)));
+    return true;
+}
+
+#if defined(RAPIDJSON_SIMD_DISPATCH)
+template<>
+inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
+    if (length < 16)
+        return RAPIDJSON_LIKELY(is.Tell() < length);
+
+    if (!RAPIDJSON_LIKELY(is.Tell() < length))
+        return false;
+
+    const char* p = is.src_;
+    const char* q = internal::GetSimdKernels().scanUnescapedEnd(p, is.head_ + length);
+    size_t len = static_cast<size_t>(q - p);
+    if (len != 0)
+        std::memcpy(os_->PushUnsafe(len), p, len);
+
+    is.src_ = q;
+    return RAPIDJSON_LIKELY(is.Tell() < length);
+}
+#elif defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
 template<>
 inline bool Writer<StringBuffer>::ScanWriteUnescapedString(StringStream& is, size_t length) {
     if (length < 16)
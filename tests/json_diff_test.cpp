@@ -0,0 +1,92 @@
+/*
+ * json_diff_test.cpp
+ * Tests of CMjson::diff() : result is applied to source, and must give target.
+ *
+ * usage : json_diff_test  (exit code 0 : pass)
+ */
+#include <stdio.h>
+#include <string>
+
+#include <json_manipulator.h>
+
+using namespace json_mng;
+
+static int failures = 0;
+
+static void expect(const std::string& name, const std::string& result, const std::string& expected) {
+    if ( result != expected ) {
+        fprintf(stderr, "FAIL %s\n  result   : %s\n  expected : %s\n", name.c_str(), result.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+/** apply(a, diff(a, b)) == b, for JSON Patch and Merge Patch. expected : dump of the result. */
+static void round_trip(const std::string& name, const std::string& a, const std::string& b, const std::string& expected) {
+    CMjson source;
+    CMjson target;
+    CJsonPatch patch;
+
+    source.parse(a, E_PARSE::E_PARSE_MESSAGE);
+    target.parse(b, E_PARSE::E_PARSE_MESSAGE);
+    const std::string text = source.diff(target);
+    if ( patch.compile(text) == false || source.apply_patch(patch) == false ) {
+        expect(name + " : patch applied", text, "(applicable patch)");
+        return;
+    }
+    expect(name + " : patch", source.dump(), expected);
+    expect(name + " : patch, no diff left", source.diff(target), "[]");
+
+    CMjson merged;
+    CMjson merge_patch;
+    merged.parse(a, E_PARSE::E_PARSE_MESSAGE);
+    merge_patch.parse(merged.diff(target, E_DIFF::E_DIFF_MERGE_PATCH), E_PARSE::E_PARSE_MESSAGE);
+    merged.merge_patch(merge_patch);
+    expect(name + " : merge patch, no diff left", merged.diff(target), "[]");
+}
+
+static void test_numbers(void) {
+    round_trip("int64 to uint64", "{\"a\":5}", "{\"a\":9223372036854775813}", "{\"a\":9223372036854775813}");
+    round_trip("uint64 to int64", "{\"a\":9223372036854775813}", "{\"a\":5}", "{\"a\":5}");
+    round_trip("negative to uint64", "{\"a\":-9223372036854775803}", "{\"a\":9223372036854775813}", "{\"a\":9223372036854775813}");
+    round_trip("int to double", "{\"a\":1,\"b\":[1,2]}", "{\"a\":1.0,\"b\":[1,2.0]}", "{\"a\":1.0,\"b\":[1,2.0]}");
+    round_trip("double to int", "{\"a\":1.0}", "{\"a\":1}", "{\"a\":1}");
+
+    CMjson source;
+    CMjson target;
+    source.parse("{\"a\":1,\"b\":18446744073709551615,\"c\":-1}", E_PARSE::E_PARSE_MESSAGE);
+    target.parse("{\"c\":-1,\"b\":18446744073709551615,\"a\":1}", E_PARSE::E_PARSE_MESSAGE);
+    expect("same numbers", source.diff(target), "[]");
+    expect("same numbers : merge patch", source.diff(target, E_DIFF::E_DIFF_MERGE_PATCH), "{}");
+}
+
+static void test_objects(void) {
+    round_trip("members", "{\"a\":1,\"b\":{\"c\":[1],\"d\":\"x\"},\"e\":null}", "{\"a\":1,\"b\":{\"c\":[1,2]},\"f\":true}",
+               "{\"a\":1,\"b\":{\"c\":[1,2]},\"f\":true}");
+    round_trip("member order", "{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}", "{\"a\":1,\"b\":2}");
+    round_trip("escaped names", "{\"a/b\":1,\"c~d\":{\"~\":2}}", "{\"a/b\":3,\"c~d\":{\"~\":4}}", "{\"a/b\":3,\"c~d\":{\"~\":4}}");
+    round_trip("wide object", "{\"k0\":0,\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":7,\"k8\":8,\"k9\":9}",
+               "{\"k9\":9,\"k8\":8,\"k7\":70,\"k6\":6,\"k5\":5,\"k4\":4,\"k3\":3,\"k2\":2,\"k1\":1,\"kA\":10}",
+               "{\"k1\":1,\"k2\":2,\"k3\":3,\"k4\":4,\"k5\":5,\"k6\":6,\"k7\":70,\"k8\":8,\"k9\":9,\"kA\":10}");
+    round_trip("type change", "{\"a\":{\"b\":1}}", "{\"a\":[{\"b\":1}]}", "{\"a\":[{\"b\":1}]}");
+}
+
+static void test_arrays(void) {
+    round_trip("insertion", "{\"a\":[1,2,3,4]}", "{\"a\":[1,2,9,3,4]}", "{\"a\":[1,2,9,3,4]}");
+    round_trip("deletion", "{\"a\":[1,2,3,4]}", "{\"a\":[1,4]}", "{\"a\":[1,4]}");
+    round_trip("replacement", "{\"a\":[{\"x\":1},{\"y\":2},3]}", "{\"a\":[{\"x\":1},{\"y\":3},[3]]}", "{\"a\":[{\"x\":1},{\"y\":3},[3]]}");
+    round_trip("to empty", "{\"a\":[1,[2],{}]}", "{\"a\":[]}", "{\"a\":[]}");
+    round_trip("from empty", "{\"a\":[]}", "{\"a\":[1,[2],{}]}", "{\"a\":[1,[2],{}]}");
+}
+
+int main(void) {
+    test_numbers();
+    test_objects();
+    test_arrays();
+
+    if ( failures != 0 ) {
+        fprintf(stderr, "%d test(s) failed.\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
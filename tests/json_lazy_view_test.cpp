@@ -0,0 +1,97 @@
+/*
+ * json_lazy_view_test.cpp
+ * Tests of object views of lazy documents : they are read-only.
+ *
+ * usage : json_lazy_view_test  (exit code 0 : pass)
+ */
+#include <stdio.h>
+#include <string>
+
+#include <json_manipulator.h>
+
+using namespace json_mng;
+
+static int failures = 0;
+
+static void expect(const std::string& name, const std::string& result, const std::string& expected) {
+    if ( result != expected ) {
+        fprintf(stderr, "FAIL %s\n  result   : %s\n  expected : %s\n", name.c_str(), result.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+static void expect(const std::string& name, bool result) {
+    if ( result == false ) {
+        fprintf(stderr, "FAIL %s\n", name.c_str());
+        failures++;
+    }
+}
+
+/** Returns whether mutation threw E_ITS_NOT_SUPPORTED_TYPE. */
+template <typename F>
+static bool rejected(F mutation) {
+    try {
+        mutation();
+    }
+    catch( const std::exception& e ) {
+        return std::string(e.what()).find("E_ITS_NOT_SUPPORTED_TYPE") != std::string::npos;
+    }
+    return false;
+}
+
+static const char* message = "{\"x\":{\"a\":1,\"b\":{\"c\":2}},\"list\":[{\"d\":3},{\"e\":4}],\"y\":5}";
+
+/** Changes of a view are seen in the dump of parent. (Reader backend) */
+static void test_reader_view(void) {
+    CMjson doc;
+    doc.parse(message, E_PARSE::E_PARSE_MESSAGE);
+
+    std::shared_ptr<CMjson> x = doc.get_member<CMjson>("x");
+    x->set_member("a", 10);
+    expect("reader view", doc.dump(), "{\"x\":{\"a\":10,\"b\":{\"c\":2}},\"list\":[{\"d\":3},{\"e\":4}],\"y\":5}");
+}
+
+/** Mutators of a lazy view throw, instead of changing a document the parent does not see. */
+static void test_lazy_view(void) {
+    CMjson doc;
+    CMjson other;
+    CJsonPatch patch;
+    doc.parse(message, E_PARSE::E_PARSE_MESSAGE, E_PARSE_BACKEND::E_PARSE_BACKEND_LAZY);
+    other.parse("{\"z\":0}", E_PARSE::E_PARSE_MESSAGE);
+    patch.compile("[{\"op\":\"add\",\"path\":\"/z\",\"value\":0}]");
+
+    std::shared_ptr<CMjson> x = doc.get_member<CMjson>("x");
+    std::shared_ptr<CMjson> b = x->get_member<CMjson>("b");
+    std::shared_ptr<CMjson> item = doc.get_array_member<CMjson>("list")->front();
+
+    expect("lazy view : read", *x->get_member<int>("a") == 1 && *b->get_member<int>("c") == 2 && *item->get_member<int>("d") == 3);
+    expect("lazy view : set_member", rejected([&]() { x->set_member("a", 10); }));
+    expect("lazy view : set_member(CMjson)", rejected([&]() { x->set_member("o", other); }));
+    expect("lazy view : set_member(CMjson) keeps value", other.dump(), "{\"z\":0}");
+    expect("lazy view : erase_member", rejected([&]() { x->erase_member("a"); }));
+    expect("lazy view : push_back", rejected([&]() { x->push_back("l", 1); }));
+    expect("lazy view : emplace_object", rejected([&]() { x->emplace_object("o"); }));
+    expect("lazy view : merge_patch", rejected([&]() { x->merge_patch(other); }));
+    expect("lazy view : apply_patch", rejected([&]() { x->apply_patch(patch); }));
+    expect("view in lazy view : set_member", rejected([&]() { b->set_member("c", 20); }));
+    expect("item of lazy array : set_member", rejected([&]() { item->set_member("d", 30); }));
+    expect("lazy view : parent", doc.dump(), "{\"x\":{\"a\":1,\"b\":{\"c\":2}},\"list\":[{\"d\":3},{\"e\":4}],\"y\":5}");
+
+    // parent itself is mutable, and a lazy view may be a patch.
+    doc.set_member("y", 50);
+    other.merge_patch(*x);
+    expect("lazy document : set_member", doc.dump(), "{\"x\":{\"a\":1,\"b\":{\"c\":2}},\"list\":[{\"d\":3},{\"e\":4}],\"y\":50}");
+    expect("lazy view : as patch", other.dump(), "{\"z\":0,\"a\":1,\"b\":{\"c\":2}}");
+}
+
+int main(void) {
+    test_reader_view();
+    test_lazy_view();
+
+    if ( failures != 0 ) {
+        fprintf(stderr, "%d test(s) failed.\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ * json_merge_patch_test.cpp
+ * Tests of CMjson::merge_patch() with patches in the same document.
+ *
+ * usage : json_merge_patch_test  (exit code 0 : pass)
+ */
+#include <stdio.h>
+#include <string>
+
+#include <json_manipulator.h>
+
+using namespace json_mng;
+
+static int failures = 0;
+
+static void expect(const std::string& name, const std::string& result, const std::string& expected) {
+    if ( result != expected ) {
+        fprintf(stderr, "FAIL %s\n  result   : %s\n  expected : %s\n", name.c_str(), result.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+/** Patch is a member of target : members of target grow while patch is read. */
+static void test_view_in_target(void) {
+    CMjson doc;
+    doc.parse("{\"a\":1,\"overlay\":{\"a\":2,\"b\":\"x\",\"c\":{\"d\":[1,2]},\"e\":null,\"f\":\"y\",\"g\":3}}", E_PARSE::E_PARSE_MESSAGE);
+
+    std::shared_ptr<CMjson> overlay = doc.get_member<CMjson>("overlay");
+    doc.merge_patch(*overlay);
+    expect("view in target", doc.dump(),
+           "{\"a\":2,\"overlay\":{\"a\":2,\"b\":\"x\",\"c\":{\"d\":[1,2]},\"e\":null,\"f\":\"y\",\"g\":3},"
+           "\"b\":\"x\",\"c\":{\"d\":[1,2]},\"f\":\"y\",\"g\":3}");
+}
+
+/** Target is a member of patch. */
+static void test_target_in_view(void) {
+    CMjson doc;
+    doc.parse("{\"inner\":{\"x\":1},\"y\":2}", E_PARSE::E_PARSE_MESSAGE);
+
+    std::shared_ptr<CMjson> inner = doc.get_member<CMjson>("inner");
+    inner->merge_patch(doc);
+    expect("target in view", doc.dump(), "{\"inner\":{\"x\":1,\"inner\":{\"x\":1},\"y\":2},\"y\":2}");
+}
+
+/** Disjoint members of one document : values are moved, and patch is left empty. */
+static void test_disjoint_views(void) {
+    CMjson doc;
+    doc.parse("{\"base\":{\"a\":1},\"overlay\":{\"a\":null,\"b\":[true]}}", E_PARSE::E_PARSE_MESSAGE);
+
+    std::shared_ptr<CMjson> base = doc.get_member<CMjson>("base");
+    std::shared_ptr<CMjson> overlay = doc.get_member<CMjson>("overlay");
+    base->merge_patch(*overlay);
+    expect("disjoint views", doc.dump(), "{\"base\":{\"b\":[true]},\"overlay\":{}}");
+}
+
+int main(void) {
+    test_view_in_target();
+    test_target_in_view();
+    test_disjoint_views();
+
+    if ( failures != 0 ) {
+        fprintf(stderr, "%d test(s) failed.\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
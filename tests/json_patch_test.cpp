@@ -0,0 +1,104 @@
+/*
+ * json_patch_test.cpp
+ * Tests of CJsonPatch : operations, and rollback of a failed patch.
+ *
+ * usage : json_patch_test  (exit code 0 : pass)
+ */
+#include <stdio.h>
+#include <string>
+
+#include <json_manipulator.h>
+
+using namespace json_mng;
+
+static int failures = 0;
+
+static void expect(const std::string& name, const std::string& result, const std::string& expected) {
+    if ( result != expected ) {
+        fprintf(stderr, "FAIL %s\n  result   : %s\n  expected : %s\n", name.c_str(), result.c_str(), expected.c_str());
+        failures++;
+    }
+}
+
+static void expect(const std::string& name, bool result) {
+    if ( result == false ) {
+        fprintf(stderr, "FAIL %s\n", name.c_str());
+        failures++;
+    }
+}
+
+/** Applies patch to document, and returns dump of it. */
+static std::string patched(const std::string& document, const std::string& patch, bool expected) {
+    CMjson doc;
+    CJsonPatch compiled;
+
+    doc.parse(document, E_PARSE::E_PARSE_MESSAGE);
+    expect("compile : " + patch, compiled.compile(patch));
+    expect("apply : " + patch, doc.apply_patch(compiled) == expected);
+    return doc.dump();
+}
+
+static void test_operations(void) {
+    const std::string doc = "{\"a\":1,\"b\":[1,2,3],\"c\":{\"d\":\"x\"}}";
+
+    expect("add member", patched(doc, "[{\"op\":\"add\",\"path\":\"/e\",\"value\":[true]}]", true),
+           "{\"a\":1,\"b\":[1,2,3],\"c\":{\"d\":\"x\"},\"e\":[true]}");
+    expect("add element", patched(doc, "[{\"op\":\"add\",\"path\":\"/b/1\",\"value\":9},{\"op\":\"add\",\"path\":\"/b/-\",\"value\":0}]", true),
+           "{\"a\":1,\"b\":[1,9,2,3,0],\"c\":{\"d\":\"x\"}}");
+    expect("remove", patched(doc, "[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"remove\",\"path\":\"/b/0\"}]", true),
+           "{\"b\":[2,3],\"c\":{\"d\":\"x\"}}");
+    expect("replace", patched(doc, "[{\"op\":\"replace\",\"path\":\"/c/d\",\"value\":null}]", true),
+           "{\"a\":1,\"b\":[1,2,3],\"c\":{\"d\":null}}");
+    expect("move", patched(doc, "[{\"op\":\"move\",\"from\":\"/c/d\",\"path\":\"/b/0\"}]", true),
+           "{\"a\":1,\"b\":[\"x\",1,2,3],\"c\":{}}");
+    expect("copy", patched(doc, "[{\"op\":\"copy\",\"from\":\"/c\",\"path\":\"/f\"}]", true),
+           "{\"a\":1,\"b\":[1,2,3],\"c\":{\"d\":\"x\"},\"f\":{\"d\":\"x\"}}");
+    expect("test", patched(doc, "[{\"op\":\"test\",\"path\":\"/b\",\"value\":[1,2,3]}]", true), doc);
+}
+
+/** Operations before the failed one are undone : document is unchanged. */
+static void test_rollback(void) {
+    const std::string doc = "{\"a\":1,\"b\":[1,2,3],\"c\":{\"d\":\"x\"}}";
+
+    expect("rollback : test failed", patched(doc,
+           "[{\"op\":\"add\",\"path\":\"/e\",\"value\":1},{\"op\":\"remove\",\"path\":\"/b/1\"},"
+           "{\"op\":\"replace\",\"path\":\"/a\",\"value\":2},{\"op\":\"move\",\"from\":\"/c/d\",\"path\":\"/b/0\"},"
+           "{\"op\":\"test\",\"path\":\"/a\",\"value\":1}]", false), doc);
+    expect("rollback : path not found", patched(doc,
+           "[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"copy\",\"from\":\"/b\",\"path\":\"/c/b\"},"
+           "{\"op\":\"add\",\"path\":\"/b/0\",\"value\":0},{\"op\":\"remove\",\"path\":\"/z\"}]", false), doc);
+    expect("rollback : move into itself", patched(doc,
+           "[{\"op\":\"replace\",\"path\":\"/c/d\",\"value\":{}},{\"op\":\"move\",\"from\":\"/c\",\"path\":\"/c/d/e\"}]", false), doc);
+
+    // patch object (and it's undo-log) is reused after a failure.
+    CMjson target;
+    CJsonPatch compiled;
+    target.parse(doc, E_PARSE::E_PARSE_MESSAGE);
+    expect("compile : reused", compiled.compile("[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"test\",\"path\":\"/b/0\",\"value\":2}]"));
+    expect("apply : reused, failed", target.apply_patch(compiled) == false);
+    target.push_back("b", 0);
+    expect("compile : reused, again", compiled.compile("[{\"op\":\"remove\",\"path\":\"/a\"},{\"op\":\"test\",\"path\":\"/b/3\",\"value\":0}]"));
+    expect("apply : reused, applied", target.apply_patch(compiled) == true);
+    expect("reused", target.dump(), "{\"b\":[1,2,3,0],\"c\":{\"d\":\"x\"}}");
+}
+
+static void test_invalid(void) {
+    CJsonPatch compiled;
+
+    expect("invalid : not an array", compiled.compile("{\"op\":\"remove\",\"path\":\"/a\"}") == false);
+    expect("invalid : unknown op", compiled.compile("[{\"op\":\"delete\",\"path\":\"/a\"}]") == false);
+    expect("invalid : no value", compiled.compile("[{\"op\":\"add\",\"path\":\"/a\"}]") == false);
+}
+
+int main(void) {
+    test_operations();
+    test_rollback();
+    test_invalid();
+
+    if ( failures != 0 ) {
+        fprintf(stderr, "%d test(s) failed.\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
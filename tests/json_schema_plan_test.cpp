@@ -0,0 +1,62 @@
+/*
+ * json_schema_plan_test.cpp
+ * Tests of CSchemaPlan with recursive "$ref".
+ *
+ * usage : json_schema_plan_test  (exit code 0 : pass)
+ */
+#include <stdio.h>
+#include <string>
+
+#include <json_manipulator.h>
+
+using namespace json_mng;
+
+static int failures = 0;
+
+static void expect(const std::string& name, bool result) {
+    if ( result == false ) {
+        fprintf(stderr, "FAIL %s\n", name.c_str());
+        failures++;
+    }
+}
+
+/** Tree node refers to root : expansion stops at the repeated schema. */
+static void test_recursive_root(void) {
+    std::shared_ptr<CJsonSchema> schema = CJsonSchema::compile(
+        "{\"type\":\"object\",\"properties\":{\"v\":{\"type\":\"integer\"},\"left\":{\"$ref\":\"#\"},\"right\":{\"$ref\":\"#\"}}}");
+    expect("compile", schema.get() != NULL);
+
+    CSchemaPlan plan(schema);
+    expect("recursive root : size", plan.size() == 3);
+    expect("recursive root : v", plan.get_type(plan.find("/v")) == E_FIELD_TYPE::E_FIELD_TYPE_INTEGER);
+    expect("recursive root : left", plan.get_type(plan.find("/left")) == E_FIELD_TYPE::E_FIELD_TYPE_OBJECT);
+    expect("recursive root : right", plan.get_type(plan.find("/right")) == E_FIELD_TYPE::E_FIELD_TYPE_OBJECT);
+    expect("recursive root : no children", plan.find("/left/v") == plan.size());
+}
+
+/** Definition refers to itself below root, and is used twice. */
+static void test_recursive_definition(void) {
+    std::shared_ptr<CJsonSchema> schema = CJsonSchema::compile(
+        "{\"definitions\":{\"node\":{\"type\":\"object\",\"properties\":{\"id\":{\"type\":\"string\"},"
+        "\"next\":{\"$ref\":\"#/definitions/node\"}}}},"
+        "\"type\":\"object\",\"properties\":{\"head\":{\"$ref\":\"#/definitions/node\"},\"tail\":{\"$ref\":\"#/definitions/node\"}}}");
+    expect("compile", schema.get() != NULL);
+
+    CSchemaPlan plan(schema);
+    expect("recursive definition : size", plan.size() == 6);
+    expect("recursive definition : head/next", plan.get_type(plan.find("/head/next")) == E_FIELD_TYPE::E_FIELD_TYPE_OBJECT);
+    expect("recursive definition : tail/id", plan.get_type(plan.find("/tail/id")) == E_FIELD_TYPE::E_FIELD_TYPE_STRING);
+    expect("recursive definition : no children", plan.find("/head/next/id") == plan.size());
+}
+
+int main(void) {
+    test_recursive_root();
+    test_recursive_definition();
+
+    if ( failures != 0 ) {
+        fprintf(stderr, "%d test(s) failed.\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * json_codegen.cpp
+ * Generates C++ structs, SAX decoders for Reader and encoders for Writer from a JSON Schema.
+ *
+ * usage : json_codegen <schema.json> <RootName> [namespace] [output.h]
+ *         code is written to stdout without output.
+ */
+#include <stdio.h>
+#include <string>
+
+#include <logger.h>
+#include <json_schema.h>
+#include <json_codegen.h>
+
+using namespace json_mng;
+
+int main(int argc, char** argv) {
+    std::string code;
+
+    if ( argc < 3 || argc > 5 ) {
+        fprintf(stderr, "usage : %s <schema.json> <RootName> [namespace] [output.h]\n", argv[0]);
+        return 2;
+    }
+
+    std::shared_ptr<CJsonSchema> schema = CJsonSchema::load(argv[1]);
+    if ( schema.get() == NULL ) {
+        LOGERR("Can not load schema.(%s)", argv[1]);
+        return 1;
+    }
+
+    CSchemaCodegen codegen(schema);
+    if ( codegen.generate(argv[2], (argc > 3) ? argv[3] : "", code) == false ) {
+        LOGERR("Can not generate code.(%s)", argv[1]);
+        return 1;
+    }
+
+    FILE* output = (argc > 4) ? fopen(argv[4], "w") : stdout;
+    if ( output == NULL ) {
+        LOGERR("Can not open file.(%s)", argv[4]);
+        return 1;
+    }
+    const bool written = (fwrite(code.data(), 1, code.size(), output) == code.size());
+    if ( output != stdout ) {
+        fclose(output);
+    }
+    if ( written == false ) {
+        LOGERR("Can not write code.");
+        return 1;
+    }
+    return 0;
+}